@@ -30,6 +30,9 @@ struct {
     const char* generalGroup = "general";
     const char* showCloseTabButton = "showCloseTabButton";
     const char* maxThreads = "maxThreads";
+    const char* searchCacheSize = "searchCacheSize";
+    const char* filterCacheSize = "filterCacheSize";
+    const char* dfaRegex = "dfaRegex";
 } g_consts;
 
 } // namespace
@@ -121,6 +124,9 @@ void Config::save() {
             g_consts.generalGroup, {
                 {g_consts.showCloseTabButton, _generalConfig.showCloseTabButton},
                 {g_consts.maxThreads, _generalConfig.maxThreads},
+                {g_consts.searchCacheSize, _generalConfig.searchCacheSize},
+                {g_consts.filterCacheSize, _generalConfig.filterCacheSize},
+                {g_consts.dfaRegex, _generalConfig.dfaRegex},
             }
         }
     };
@@ -178,6 +184,21 @@ void Config::init(std::shared_ptr<IFileSystem> fileSystem) {
         _generalConfig.maxThreads = jMaxThreads.get<unsigned>();
     }
 
+    auto jSearchCacheSize = general[g_consts.searchCacheSize];
+    if (!jSearchCacheSize.is_null()) {
+        _generalConfig.searchCacheSize = jSearchCacheSize.get<unsigned>();
+    }
+
+    auto jFilterCacheSize = general[g_consts.filterCacheSize];
+    if (!jFilterCacheSize.is_null()) {
+        _generalConfig.filterCacheSize = jFilterCacheSize.get<unsigned>();
+    }
+
+    auto jDfaRegex = general[g_consts.dfaRegex];
+    if (!jDfaRegex.is_null()) {
+        _generalConfig.dfaRegex = jDfaRegex.get<bool>();
+    }
+
     auto session = j[g_consts.sessionGroup];
     if (!session.is_null()) {
         auto openedFiles = session[g_consts.sessionOpenedFiles];
@@ -48,6 +48,9 @@ struct SessionConfig {
 struct GeneralConfig {
     bool showCloseTabButton = true;
     unsigned maxThreads = 10;
+    unsigned searchCacheSize = 64;
+    unsigned filterCacheSize = 64;
+    bool dfaRegex = false;
 };
 
 class IFileSystem {
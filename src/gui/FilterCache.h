@@ -0,0 +1,40 @@
+#pragma once
+
+#include "gui/grid/LruCache.h"
+#include "seer/Index.h"
+#include <boost/container_hash/hash.hpp>
+#include <map>
+#include <set>
+#include <string>
+#include <memory>
+
+namespace gui {
+
+// the filter of each column, as LogFile keeps them
+using FilterCacheKey = std::map<int, seer::ColumnFilter>;
+
+struct FilterCacheKeyHash {
+    size_t operator()(const FilterCacheKey& key) const {
+        size_t seed = 0;
+        for (const auto& [column, filter] : key) {
+            boost::hash_combine(seed, column);
+            boost::hash_combine(seed, filter.exclude);
+            boost::hash_range(seed, filter.selected.begin(), filter.selected.end());
+        }
+        return seed;
+    }
+};
+
+inline size_t filterCacheKeySizeInBytes(const FilterCacheKey& key) {
+    size_t size = 0;
+    for (const auto& [_, filter] : key) {
+        size += filter.sizeInBytes();
+    }
+    return size;
+}
+
+// recently applied filters weighted by the size of their snapshots and keys in bytes
+using FilterCache =
+    LruCache<FilterCacheKey, std::shared_ptr<const seer::FilterSnapshot>, FilterCacheKeyHash>;
+
+} // namespace gui
@@ -6,10 +6,35 @@
 
 namespace gui {
 
+namespace {
+
+// the number of bytes QString::toUtf8 produces, a lone surrogate becomes U+FFFD
+int utf8Size(QStringView str) {
+    int size = 0;
+    for (qsizetype i = 0; i < str.size(); ++i) {
+        auto ch = str[i];
+        if (ch.unicode() < 0x80) {
+            size += 1;
+        } else if (ch.unicode() < 0x800) {
+            size += 2;
+        } else if (ch.isHighSurrogate() && i + 1 < str.size() && str[i + 1].isLowSurrogate()) {
+            size += 4;
+            ++i;
+        } else {
+            size += 3;
+        }
+    }
+    return size;
+}
+
+} // namespace
+
 GraphemeMap::GraphemeMap(QString line, IFontMetrics* metrics) : _line(line) {
     if (line.size() == 0)
         return;
 
+    _utf8 = line.toStdString();
+
     auto getWidth = [&] (auto str) {
         if (metrics)
             return metrics->width(str);
@@ -19,6 +44,7 @@ GraphemeMap::GraphemeMap(QString line, IFontMetrics* metrics) : _line(line) {
     float position = 0;
     int prevIndex = 0;
     int grapheme = 0;
+    int byte = 0;
 
     auto tabWidth = getWidth(" ") * seer::g_tabWidth;
 
@@ -30,6 +56,8 @@ GraphemeMap::GraphemeMap(QString line, IFontMetrics* metrics) : _line(line) {
         }
         _graphemeToIndex.push_back(prevIndex);
         _graphemePositions.push_back(position);
+        _graphemeToByte.push_back(byte);
+        byte += utf8Size(QStringView(line).mid(prevIndex, indexLen));
 
         if (line[prevIndex] == '\t') {
             position += tabWidth - std::fmod(position, tabWidth);
@@ -42,6 +70,7 @@ GraphemeMap::GraphemeMap(QString line, IFontMetrics* metrics) : _line(line) {
     }
 
     _graphemePositions.push_back(position);
+    assert(byte == std::ssize(_utf8));
 
     finder = QTextBoundaryFinder(QTextBoundaryFinder::Word, line);
     int wordName = 0;
@@ -124,6 +153,23 @@ const QString& GraphemeMap::line() const {
     return _line;
 }
 
+const std::string& GraphemeMap::utf8() const {
+    return _utf8;
+}
+
+int GraphemeMap::byteToGrapheme(int byte) const {
+    assert(0 <= byte && byte < std::ssize(_utf8));
+    auto it = std::upper_bound(begin(_graphemeToByte), end(_graphemeToByte), byte);
+    return std::distance(begin(_graphemeToByte), it) - 1;
+}
+
+int GraphemeMap::graphemeToByte(int grapheme) const {
+    assert(grapheme <= std::ssize(_graphemeToByte));
+    if (grapheme == std::ssize(_graphemeToByte))
+        return _utf8.size();
+    return _graphemeToByte[grapheme];
+}
+
 int GraphemeMap::pixelWidth() const {
     if (_graphemePositions.empty())
         return 0;
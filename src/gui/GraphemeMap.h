@@ -3,6 +3,7 @@
 #include <seer/Index.h>
 
 #include <QString>
+#include <string>
 #include <vector>
 
 namespace gui {
@@ -17,7 +18,9 @@ class GraphemeMap {
     std::vector<int> _graphemeToIndex;
     std::vector<int> _graphemeWords;
     std::vector<float> _graphemePositions;
+    std::vector<int> _graphemeToByte;
     QString _line;
+    std::string _utf8;
 
 public:
     GraphemeMap(QString line, IFontMetrics* metrics);
@@ -28,6 +31,10 @@ public:
     int indexToGrapheme(int index) const;
     std::tuple<int, int> graphemeToIndexRange(int grapheme) const;
     const QString& line() const;
+    // the line in UTF-8, byte offsets into it map to graphemes
+    const std::string& utf8() const;
+    int byteToGrapheme(int byte) const;
+    int graphemeToByte(int grapheme) const;
     int pixelWidth() const;
 };
 
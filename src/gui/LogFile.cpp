@@ -1,6 +1,8 @@
 #include "LogFile.h"
+#include "Config.h"
 
 #include <algorithm>
+#include <utility>
 
 using namespace seer::task;
 
@@ -10,12 +12,21 @@ LogFile::LogFile(std::unique_ptr<std::istream> stream,
                  std::shared_ptr<seer::ILineParser> lineParser)
     : _lineParser(lineParser),
       _stream(std::move(stream)),
-      _sm(static_cast<IStateHandler*>(this), _smLogger) {}
+      _sm(static_cast<IStateHandler*>(this), _smLogger),
+      _searchCache(size_t{g_Config.generalConfig().searchCacheSize} << 20),
+      _filterCache(size_t{g_Config.generalConfig().filterCacheSize} << 20) {}
+
+LogFile::~LogFile() {
+    // filtering threads report to the dispatcher, they have to finish while it still exists
+    stopFiltering();
+    _stoppedFilteringTasks.clear();
+}
 
 void LogFile::enterIndexing() {
     emit stateChanged();
     _fileParser = std::make_unique<seer::FileParser>(_stream.get(), _lineParser.get());
-    _index = std::make_unique<seer::Index>(_fileParser->lineCount());
+    _index = std::make_shared<seer::Index>(_fileParser->lineCount());
+    _appliedFilters.reset();
     _indexingTask = createIndexingTask(_index.get(), _fileParser.get(), _lineParser.get());
     _indexingTask->setStateChanged([this](auto state) {
         assert(state != TaskState::Failed);
@@ -45,49 +56,119 @@ void LogFile::resumeIndexing() {
     }
 }
 
+bool LogFile::isRefinement(const sm::SearchEvent& event) const {
+    if (!_searchIndex || !_lastSearch || _lastSearchFilters != _appliedFilters)
+        return false;
+    auto& last = *_lastSearch;
+    return !event.regex && !last.regex
+        && event.column == -1 && last.column == -1
+        && event.caseSensitive == last.caseSensitive
+        && event.unicodeAware == last.unicodeAware
+        && event.messageOnly == last.messageOnly
+        && event.text.find(last.text) != std::string::npos;
+}
+
 void LogFile::searchFromComplete(sm::SearchEvent event) {
     emit stateChanged();
+    if (_filteringTask) {
+        _pendingSearch = event;
+        return;
+    }
+    startSearch(event);
+}
+
+void LogFile::startSearch(sm::SearchEvent event) {
+    SearchCacheKey key{event.text,
+                       event.regex,
+                       event.caseSensitive,
+                       event.unicodeAware,
+                       event.messageOnly,
+                       event.column,
+                       _appliedFilters.value_or(std::map<int, seer::ColumnFilter>{})};
+    if (auto cached = _searchCache.lookup(key)) {
+        _searchingTask.reset();
+        auto index = std::make_shared<seer::Index>(*_index);
+        index->restoreSearchResults((*cached)->lines, (*cached)->regexLimitHits);
+        _dispatcher.postToUIThread([=, this, hist = (*cached)->hist] {
+            _lastSearch = event;
+            _lastSearchFilters = key.filters;
+            publishSearchResults(index, hist);
+            finish();
+        });
+        return;
+    }
     _searchingTask = std::make_unique<SearchingTask>(_fileParser.get(),
                                                      _index.get(),
                                                      event.text,
                                                      event.regex,
                                                      event.caseSensitive,
                                                      event.unicodeAware,
-                                                     event.messageOnly);
-    _searchingTask->setStateChanged([this](auto state) {
+                                                     event.messageOnly,
+                                                     event.column,
+                                                     isRefinement(event) ? _searchIndex : nullptr);
+    _searchingTask->setStateChanged([=, this](auto state) {
         _dispatcher.postToUIThread([=, this] {
             if (state == TaskState::Finished) {
-                auto newSearchTableModel = std::make_unique<LogTableModel>(_fileParser.get());
-                subscribeToSelectionChanged(newSearchTableModel.get());
-                _searchLogTableModel = std::move(newSearchTableModel);
-                _searchHist = _searchingTask->hist();
-                _searchIndex = _searchingTask->index();
-                _searchLogTableModel->setIndex(_searchIndex.get());
+                _lastSearch = event;
+                _lastSearchFilters = key.filters;
+                publishSearchResults(_searchingTask->index(), _searchingTask->hist());
+                auto entry = std::make_shared<SearchCacheEntry>(
+                    SearchCacheEntry{_searchIndex->searchResults(),
+                                     _searchHist,
+                                     _searchIndex->regexLimitHits()});
+                _searchCache.insert(key, entry, entry->sizeInBytes());
                 finish();
             } else if (state == TaskState::Stopped) {
                 _searchLogTableModel = nullptr;
                 _searchHist.reset();
                 _searchIndex.reset();
+                _lastSearch.reset();
                 finish();
             }
         });
     });
+    _searchingTask->setResultsChanged([this, index = _searchingTask->index()] {
+        _dispatcher.postToUIThread([=, this] {
+            if (_searchingTask && _searchingTask->index() == index) {
+                publishSearchResults(index, _searchingTask->hist());
+            }
+        });
+    });
     _searchingTask->setProgressChanged([this](auto progress) {
         _dispatcher.postToUIThread([=, this] { emit progressChanged(progress); });
     });
     _searchingTask->start();
 }
 
+void LogFile::publishSearchResults(std::shared_ptr<seer::Index> index,
+                                   std::shared_ptr<seer::Hist> hist) {
+    if (_searchIndex != index) {
+        auto newSearchTableModel = std::make_unique<LogTableModel>(_fileParser.get());
+        subscribeToSelectionChanged(newSearchTableModel.get());
+        _searchLogTableModel = std::move(newSearchTableModel);
+        _searchHist = hist;
+        _searchIndex = index;
+        _searchLogTableModel->setIndex(_searchIndex.get());
+        emit stateChanged();
+    } else {
+        _searchLogTableModel->appendRows();
+        emit searchResultsChanged();
+    }
+}
+
 void LogFile::enterFailed() {
     emit stateChanged();
 }
 
 void LogFile::enterComplete() {
     logTableModel()->showIndexedColumns();
-    adaptFilter();
-    applyFilter();
 
     if (!_indexingComplete) {
+        // a freshly indexed file is unfiltered, clearing the filters later is then instant
+        logTableModel()->setIndex(_index.get());
+        _appliedFilters.emplace();
+        auto snapshot = _index->filterSnapshot();
+        _filterCache.insert({}, snapshot, snapshot->sizeInBytes());
         std::vector<seer::ColumnWidth> widths;
         auto columnCount = logTableModel()->columnCount({});
         widths.push_back({logTableModel()->rowCount({}) - 1, 0});
@@ -98,6 +179,9 @@ void LogFile::enterComplete() {
         _indexingComplete = true;
     }
 
+    adaptFilter();
+    applyFilter();
+
     emit stateChanged();
 }
 
@@ -112,8 +196,13 @@ void LogFile::enterInterrupted() {
             _lineParser = std::move(event->parser);
         }
         _stream = std::move(event->stream);
+        stopFiltering();
         _logTableModel.reset();
         _searchLogTableModel.reset();
+        _searchIndex.reset();
+        _lastSearch.reset();
+        _searchCache.clear();
+        _filterCache.clear();
         _indexingComplete = false;
         index();
     } else {
@@ -122,8 +211,57 @@ void LogFile::enterInterrupted() {
 }
 
 void LogFile::searchFromSearching(sm::SearchEvent /*event*/) {
-    if (_searchingTask)
+    if (_pendingSearch) {
+        _pendingSearch.reset();
+        _dispatcher.postToUIThread([this] { finish(); });
+    } else if (_searchingTask) {
         _searchingTask->stop();
+    }
+}
+
+// the selected row of the main table is the starting point, the row found becomes the selection
+void LogFile::find(std::string text,
+                   bool regex,
+                   bool caseSensitive,
+                   bool unicodeAware,
+                   bool messageOnly,
+                   bool backward) {
+    if (!isState(sm::CompleteState) || _findingTask)
+        return;
+
+    std::optional<uint64_t> row;
+    if (auto selection = _logTableModel->getRowSelection()) {
+        row = backward ? selection->first : selection->last;
+    }
+
+    _findingTask = std::make_shared<FindingTask>(_fileParser.get(),
+                                                 _index.get(),
+                                                 row,
+                                                 backward,
+                                                 text,
+                                                 regex,
+                                                 caseSensitive,
+                                                 unicodeAware,
+                                                 messageOnly);
+    _findingTask->setStateChanged([this, weakTask = std::weak_ptr(_findingTask)](auto state) {
+        if (state != TaskState::Finished && state != TaskState::Stopped)
+            return;
+        _dispatcher.postToUIThread([=, this] {
+            auto task = weakTask.lock();
+            if (!task || task != _findingTask)
+                return;
+            auto result = task->result();
+            _findingTask.reset();
+            if (result) {
+                auto found = _logTableModel->findRow(*result);
+                if (found != -1) {
+                    _logTableModel->setSelection(found, 0, 0);
+                }
+            }
+            emit findFinished(result.has_value());
+        });
+    });
+    _findingTask->start();
 }
 
 void LogFile::subscribeToSelectionChanged(LogTableModel* model) {
@@ -136,45 +274,125 @@ void LogFile::subscribeToSelectionChanged(LogTableModel* model) {
     });
 }
 
-void LogFile::applyFilter() {
-    int selectedLineOffset = -1;
+void LogFile::stopFiltering() {
+    if (_filteringTask) {
+        _filteringTask->stop();
+        _stoppedFilteringTasks.push_back(std::move(_filteringTask));
+    }
+}
+
+void LogFile::publishFilteredIndex(std::shared_ptr<seer::Index> index,
+                                   std::map<int, seer::ColumnFilter> filters) {
+    // read through the index the table still shows, before it is replaced
+    std::optional<uint64_t> selectedLineOffset;
     if (auto selection = _logTableModel->getRowSelection()) {
         selectedLineOffset = _logTableModel->lineOffset(selection->first);
     }
 
-    std::vector<seer::ColumnFilter> filters;
-    for (auto i = 0; i < _logTableModel->columnCount({}); ++i) {
-        _logTableModel->setFilterActive(i, false);
-    }
-    for (auto& [c, v] : _columnFilters) {
-        _logTableModel->setFilterActive(c + 1, v.size() != _index->numberOfValues(c));
-        filters.push_back({c, v});
-    }
-    _index->filter(filters);
+    // the previous index stays alive until the table no longer refers to it
+    auto previous = std::exchange(_index, std::move(index));
     _logTableModel->setIndex(_index.get());
+    _appliedFilters = std::move(filters);
 
-    auto selectedRow = _logTableModel->findRow(selectedLineOffset);
+    auto selectedRow = selectedLineOffset ? _logTableModel->findRow(*selectedLineOffset) : -1;
     _logTableModel->setSelection(selectedRow, 0, 0);
 
     for (auto& [_, model] : _filterModels) {
         model->refresh();
     }
+
+    auto snapshot = _index->filterSnapshot();
+    _filterCache.insert(*_appliedFilters,
+                        snapshot,
+                        snapshot->sizeInBytes() + filterCacheKeySizeInBytes(*_appliedFilters));
+    log_infof("filter cache holds {} filters in {:.2f} MB",
+              _filterCache.size(),
+              static_cast<double>(_filterCache.weight()) / (1 << 20));
+}
+
+void LogFile::startPendingSearch() {
+    if (_pendingSearch) {
+        startSearch(*std::exchange(_pendingSearch, std::nullopt));
+    }
+}
+
+void LogFile::applyFilter() {
+    for (auto i = 0; i < _logTableModel->columnCount({}); ++i) {
+        _logTableModel->setFilterActive(i, false);
+    }
+    std::vector<seer::ColumnFilter> filters;
+    for (auto& [c, filter] : _columnFilters) {
+        auto active = filter.exclude ? !filter.selected.empty()
+                                     : filter.selected.size() != _index->numberOfValues(c);
+        _logTableModel->setFilterActive(c + 1, active);
+        filters.push_back(filter);
+    }
+
+    if (_filteringTask) {
+        if (_filteringFilters == _columnFilters)
+            return;
+        stopFiltering();
+    } else if (_appliedFilters == _columnFilters) {
+        return;
+    }
+
+    // the filtered lines are shared with the snapshot, restoring them doesn't copy them; the
+    // table keeps mapping its rows through the current index until the copy is published
+    if (auto cached = _filterCache.lookup(_columnFilters)) {
+        auto index = std::make_shared<seer::Index>(*_index);
+        index->restoreFilter(**cached);
+        publishFilteredIndex(std::move(index), _columnFilters);
+        startPendingSearch();
+        return;
+    }
+
+    // removing every filter only drops the line map, there is nothing worth a task
+    if (filters.empty()) {
+        auto index = std::make_shared<seer::Index>(*_index);
+        index->filter(filters);
+        publishFilteredIndex(std::move(index), _columnFilters);
+        startPendingSearch();
+        return;
+    }
+
+    std::vector<int> valueColumns;
+    for (auto& [c, _] : _filterModels) {
+        valueColumns.push_back(c);
+    }
+
+    _filteringFilters = _columnFilters;
+    _filteringTask = std::make_shared<FilteringTask>(_index.get(), filters, valueColumns);
+    _filteringTask->setStateChanged([this, weakTask = std::weak_ptr(_filteringTask)](auto state) {
+        if (state != TaskState::Finished && state != TaskState::Stopped)
+            return;
+        _dispatcher.postToUIThread([=, this] {
+            auto task = weakTask.lock();
+            if (!task)
+                return;
+            if (task != _filteringTask) {
+                std::erase(_stoppedFilteringTasks, task);
+                return;
+            }
+            _filteringTask.reset();
+            publishFilteredIndex(task->index(), std::move(_filteringFilters));
+            startPendingSearch();
+        });
+    });
+    _filteringTask->start();
 }
 
 void LogFile::adaptFilter() {
-    for (auto& [c, filters] : _columnFilters) {
-        std::vector<std::string> values;
-        for (auto& info : _index->getValues(c)) {
-            values.push_back(info.value);
-        }
+    for (auto& [c, filter] : _columnFilters) {
+        auto values = _index->getValueNames(c);
+        std::ranges::sort(values);
 
         std::set<std::string> intersection;
         std::set_intersection(begin(values),
                               end(values),
-                              begin(filters),
-                              end(filters),
+                              begin(filter.selected),
+                              end(filter.selected),
                               std::inserter(intersection, begin(intersection)));
-        filters = intersection;
+        filter.selected = intersection;
     }
 }
 
@@ -195,6 +413,10 @@ LogTableModel *LogFile::searchLogTableModel() {
     return _searchLogTableModel.get();
 }
 
+uint64_t LogFile::searchRegexLimitHits() {
+    return _searchIndex ? _searchIndex->regexLimitHits() : 0;
+}
+
 const seer::Hist* LogFile::searchHist() {
     return _searchHist.get();
 }
@@ -216,31 +438,52 @@ void LogFile::clearFilter(int column) {
 void LogFile::excludeValue(int column, const std::string& value) {
     column--;
 
+    // a column without a filter only records the excluded value, not every other one
     auto it = _columnFilters.find(column);
-    if (it != end(_columnFilters)) {
-        it->second.erase(value);
+    if (it == end(_columnFilters)) {
+        _columnFilters[column] = {column, {value}, true};
+    } else if (it->second.exclude) {
+        it->second.selected.insert(value);
     } else {
-        std::set<std::string> filter;
-        for (const auto& info : _index->getValues(column)) {
-            if (info.value != value) {
-                filter.insert(info.value);
-            }
-        }
-        _columnFilters[column] = filter;
+        it->second.selected.erase(value);
     }
 
     applyFilter();
 }
 
 void LogFile::includeOnlyValue(int column, const std::string& value) {
-    _columnFilters[column - 1] = {value};
+    _columnFilters[column - 1] = {column - 1, {value}};
+    applyFilter();
+}
+
+void LogFile::includeValueRange(int column,
+                                const std::optional<std::string>& low,
+                                const std::optional<std::string>& high) {
+    column--;
+
+    auto range = _index->valuesInRange(column, low, high);
+    if (auto it = _columnFilters.find(column); it != end(_columnFilters)) {
+        auto& filter = it->second;
+        std::erase_if(range, [&](auto& value) {
+            return filter.selected.contains(value) == filter.exclude;
+        });
+    }
+    _columnFilters[column] = {column, std::move(range)};
     applyFilter();
 }
 
+bool LogFile::isFiltering() const {
+    return _filteringTask != nullptr;
+}
+
 void LogFile::reload(std::shared_ptr<std::istream> stream,
                      std::shared_ptr<seer::ILineParser> parser) {
     _scheduledReload = {stream, parser};
     _filterModels.clear();
+    if (_findingTask) {
+        _findingTask->stop();
+        _findingTask.reset();
+    }
     interrupt();
 }
 
@@ -261,7 +504,9 @@ void LogFile::requestFilter(int column) {
 
     auto it = _filterModels.find(column - 1);
     if (it == end(_filterModels)) {
-        auto model = std::make_shared<FilterTableModel>([=, this] { return _index->getValues(column - 1); });
+        auto model = std::make_shared<FilterTableModel>([=, this] {
+            return _index->getValues(column - 1, g_Config.generalConfig().maxThreads);
+        });
         std::tie(it, std::ignore) = _filterModels.emplace(column - 1, model);
     }
 
@@ -272,12 +517,23 @@ void LogFile::requestFilter(int column) {
 void LogFile::setColumnFilter(int column, std::set<std::string> values) {
     if (column == 0)
         return;
-    _columnFilters[column - 1] = values;
+    _columnFilters[column - 1] = {column - 1, std::move(values)};
     applyFilter();
 }
 
 std::set<std::string> LogFile::getColumnFilter(int column) {
-    return _columnFilters[column - 1];
+    auto it = _columnFilters.find(column - 1);
+    if (it == end(_columnFilters))
+        return {};
+    if (!it->second.exclude)
+        return it->second.selected;
+    std::set<std::string> selected;
+    for (auto& name : _index->getValueNames(column - 1)) {
+        if (!it->second.selected.contains(name)) {
+            selected.insert(std::move(name));
+        }
+    }
+    return selected;
 }
 
 } // namespace gui
@@ -2,12 +2,16 @@
 
 #include "LogTableModel.h"
 #include "FilterTableModel.h"
+#include "SearchCache.h"
+#include "FilterCache.h"
 #include "ThreadDispatcher.h"
 #include "seer/FileParser.h"
 #include "seer/ILineParser.h"
 #include "seer/ILineParserRepository.h"
 #include "seer/task/IndexingTask.h"
 #include "seer/task/SearchingTask.h"
+#include "seer/task/FindingTask.h"
+#include "seer/task/FilteringTask.h"
 #include "seer/Log.h"
 #include "seer/Hist.h"
 #include "sm/Logger.h"
@@ -17,6 +21,7 @@
 #include <memory>
 #include <string>
 #include <map>
+#include <vector>
 #include <set>
 #include <atomic>
 #include <istream>
@@ -28,21 +33,33 @@ class LogFile : public QObject, sm::IStateHandler {
     Q_OBJECT
     std::unique_ptr<seer::FileParser> _fileParser;
     std::shared_ptr<seer::ILineParser> _lineParser;
-    std::unique_ptr<seer::Index> _index;
+    std::shared_ptr<seer::Index> _index;
     std::shared_ptr<seer::Index> _searchIndex;
     std::unique_ptr<LogTableModel> _logTableModel;
     std::unique_ptr<LogTableModel> _searchLogTableModel;
-    std::map<int, std::set<std::string>> _columnFilters;
+    std::map<int, seer::ColumnFilter> _columnFilters;
     std::shared_ptr<std::istream> _stream;
     std::shared_ptr<seer::task::Task> _indexingTask;
     std::unique_ptr<seer::task::SearchingTask> _searchingTask;
+    std::shared_ptr<seer::task::FindingTask> _findingTask;
+    std::shared_ptr<seer::task::FilteringTask> _filteringTask;
+    // superseded tasks are kept until their thread finishes so that cancelling doesn't block
+    std::vector<std::shared_ptr<seer::task::FilteringTask>> _stoppedFilteringTasks;
+    std::map<int, seer::ColumnFilter> _filteringFilters;
+    std::optional<std::map<int, seer::ColumnFilter>> _appliedFilters;
+    // a search requested while filtering, it starts once the filtered index is published
+    std::optional<sm::SearchEvent> _pendingSearch;
     std::shared_ptr<seer::Hist> _searchHist;
+    std::optional<sm::SearchEvent> _lastSearch;
+    std::map<int, seer::ColumnFilter> _lastSearchFilters;
     sm::Logger _smLogger;
     boost::sml::sm<sm::StateMachine, boost::sml::logger<sm::Logger>> _sm;
     ThreadDispatcher _dispatcher;
     bool _indexingComplete = false;
     std::optional<sm::ReloadEvent> _scheduledReload;
     std::map<int, std::shared_ptr<FilterTableModel>> _filterModels;
+    SearchCache _searchCache;
+    FilterCache _filterCache;
 
     void enterIndexing() override;
     void interruptIndexing() override;
@@ -62,6 +79,13 @@ class LogFile : public QObject, sm::IStateHandler {
     }
 
     void subscribeToSelectionChanged(LogTableModel* model);
+    bool isRefinement(const sm::SearchEvent& event) const;
+    void startSearch(sm::SearchEvent event);
+    void publishSearchResults(std::shared_ptr<seer::Index> index, std::shared_ptr<seer::Hist> hist);
+    void stopFiltering();
+    void publishFilteredIndex(std::shared_ptr<seer::Index> index,
+                              std::map<int, seer::ColumnFilter> filters);
+    void startPendingSearch();
     void applyFilter();
     void adaptFilter();
 
@@ -74,7 +98,7 @@ protected:
 public:
     LogFile(std::unique_ptr<std::istream> stream,
             std::shared_ptr<seer::ILineParser> lineParser);
-    ~LogFile() = default;
+    ~LogFile();
 
     void index() {
         _sm.process_event(sm::IndexEvent{});
@@ -84,10 +108,19 @@ public:
                 bool regex,
                 bool caseSensitive,
                 bool unicodeAware,
-                bool messageOnly) {
-        _sm.process_event(sm::SearchEvent{text, regex, caseSensitive, unicodeAware, messageOnly});
+                bool messageOnly,
+                int column = -1) {
+        _sm.process_event(
+            sm::SearchEvent{text, regex, caseSensitive, unicodeAware, messageOnly, column});
     }
 
+    void find(std::string text,
+              bool regex,
+              bool caseSensitive,
+              bool unicodeAware,
+              bool messageOnly,
+              bool backward);
+
     void interrupt() {
         _sm.process_event(sm::InterruptEvent{});
     }
@@ -103,11 +136,18 @@ public:
     LogTableModel* logTableModel();
     LogTableModel* searchLogTableModel();
     const seer::Hist* searchHist();
+    uint64_t searchRegexLimitHits();
     seer::ILineParser* lineParser();
     void clearFilters();
     void clearFilter(int column);
     void excludeValue(int column, const std::string& value);
     void includeOnlyValue(int column, const std::string& value);
+    // keeps the values between the bounds in the order the parser gives the column, among those
+    // the column's filter already keeps so that a lower and an upper bound make a range
+    void includeValueRange(int column,
+                           const std::optional<std::string>& low,
+                           const std::optional<std::string>& high);
+    bool isFiltering() const;
 
     template <class S>
     bool isState(S state) {
@@ -117,6 +157,8 @@ public:
 signals:
     void filterRequested(std::shared_ptr<FilterTableModel> model, int column, std::string header);
     void stateChanged();
+    void searchResultsChanged();
+    void findFinished(bool found);
     void progressChanged(int progress);
 };
 
@@ -2,12 +2,13 @@
 
 #include <QColor>
 #include <gui/GraphemeMap.h>
-#include <boost/range/irange.hpp>
 #include <fmt/format.h>
 #include <numeric>
 
 namespace gui {
 
+constexpr uint64_t g_copyChunkSize = 4096;
+
 enum ColumnType {
     LineNumber = 0,
     Regular = 1
@@ -74,11 +75,8 @@ LogTableSelection LogTableModel::getSelection() const {
 std::vector<std::string> LogTableModel::values(int column) const {
     if (!_index)
         return {};
-    std::vector<std::string> values;
-    for (const auto& info : _index->getValues(column - 1)) {
-        values.push_back(info.value);;
-    }
-    return values;
+    // only the names are needed, counting them would take every core
+    return _index->getValueNames(column - 1);
 }
 
 LogTableModel::LogTableModel(seer::FileParser* parser)
@@ -88,6 +86,7 @@ LogTableModel::LogTableModel(seer::FileParser* parser)
     for (auto& column : parser->lineParser()->getColumnFormats()) {
         _columns.push_back(
             {QString::fromStdString(column.header), column.indexed, column.autosize});
+        _columns.back().ordered = column.order.kind != seer::ValueOrder::Kind::Lexicographic;
     }
 }
 
@@ -101,21 +100,48 @@ void LogTableModel::setFilterActive(int column, bool active) {
 
 void LogTableModel::setIndex(seer::Index* index) {
     _index = index;
+    _rowCount = _index ? _index->getLineCount() : 0;
+    _prefetchedRows.clear();
     invalidate();
 }
 
+void LogTableModel::appendRows() {
+    assert(_index);
+    auto rowCount = static_cast<int>(_index->getLineCount());
+    if (rowCount <= _rowCount)
+        return;
+    beginInsertRows({}, _rowCount, rowCount - 1);
+    _rowCount = rowCount;
+    endInsertRows();
+}
+
 void LogTableModel::showIndexedColumns() {
     _showIndexedColumns = true;
 }
 
-void LogTableModel::copyRawLines(uint64_t begin, uint64_t end, LogTableModel::LineHandler accept) {
+void LogTableModel::readLines(uint64_t begin,
+                              uint64_t end,
+                              std::function<void(uint64_t, const std::string&)> accept) {
+    std::vector<uint64_t> lineOffsets;
     std::string line;
-    for (auto i = begin; i != end; ++i) {
-        _parser->readLine(lineOffset(i), line);
-        accept(line);
+    for (auto first = begin; first < end; first += g_copyChunkSize) {
+        lineOffsets.resize(std::min(g_copyChunkSize, end - first));
+        if (_index) {
+            _index->mapRange(first, lineOffsets);
+        } else {
+            std::iota(lineOffsets.begin(), lineOffsets.end(), first);
+        }
+        for (auto offset : lineOffsets) {
+            _parser->readLine(offset, line);
+            accept(offset, line);
+        }
     }
 }
 
+void LogTableModel::copyRawLines(uint64_t begin, uint64_t end, LogTableModel::LineHandler accept) {
+    readLines(begin, end, [&](auto, auto& line) { accept(line); });
+}
+
 size_t graphemeLength(const std::string& str) {
     GraphemeMap gmap(QString::fromStdString(str), nullptr);
     return gmap.graphemeSize();
@@ -128,8 +154,9 @@ void LogTableModel::copyLines(uint64_t begin, uint64_t end, LogTableModel::LineH
         widths.push_back(_columns[i].name.size());
     }
     std::vector<std::string> columns;
+    auto context = _parser->lineParser()->createContext();
     copyRawLines(begin, end, [&] (auto& line) {
-        if (_parser->lineParser()->parseLine(line, columns, *_parser->lineParser()->createContext())) {
+        if (_parser->lineParser()->parseLine(line, columns, *context)) {
             for (auto i = 0u; i < columns.size(); ++i) {
                 auto& width = widths.at(i + 1);
                 width = std::max(width, graphemeLength(columns[i]));
@@ -169,11 +196,10 @@ void LogTableModel::copyLines(uint64_t begin, uint64_t end, LogTableModel::LineH
     appendSpaces(separatorWidth, '-');
     accept(formatted);
 
-    auto index = begin;
-    copyRawLines(begin, end, [&] (auto& line) {
+    readLines(begin, end, [&] (auto offset, auto& line) {
         formatted.clear();
-        if (_parser->lineParser()->parseLine(line, columns, *_parser->lineParser()->createContext())) {
-            append(fmt::format("{}", lineOffset(index) + 1), 0);
+        if (_parser->lineParser()->parseLine(line, columns, *context)) {
+            append(fmt::format("{}", offset + 1), 0);
             for (auto i = 0u; i < columns.size(); ++i) {
                 append(columns[i], i + 1);
             }
@@ -183,31 +209,36 @@ void LogTableModel::copyLines(uint64_t begin, uint64_t end, LogTableModel::LineH
             append(line, widths.size() - 1);
         }
         accept(formatted);
-        index++;
     });
 }
 
 uint64_t LogTableModel::lineOffset(uint64_t row) const {
-    return _index ? _index->mapIndex(row) : row;
+    if (!_index)
+        return row;
+    if (row - _prefetchedFirstRow < _prefetchedRows.size())
+        return _prefetchedRows[row - _prefetchedFirstRow];
+    return _index->mapIndex(row);
+}
+
+void LogTableModel::prefetchRows(int first, int count) {
+    if (!_index)
+        return;
+    count = std::clamp(count, 0, std::max(0, _rowCount - first));
+    if (static_cast<uint64_t>(first) == _prefetchedFirstRow &&
+        static_cast<size_t>(count) == _prefetchedRows.size())
+        return;
+    _prefetchedFirstRow = first;
+    _prefetchedRows.resize(count);
+    _index->mapRange(first, _prefetchedRows);
 }
 
 int LogTableModel::findRow(uint64_t lineOffset) {
     if (!_index)
         return lineOffset;
-    auto rows = boost::irange(0, rowCount({}), 1);
-    auto it = std::lower_bound(
-        rows.begin(), rows.end(), lineOffset, [this](auto row, auto offset) {
-            auto rowOffset = _index->mapIndex(row);
-            return rowOffset < offset;
-        });
-
-    if (it == rows.end())
-        return -1;
-
-    if (_index->mapIndex(*it) != lineOffset)
+    auto row = _index->findIndex(lineOffset);
+    if (!row || *row >= static_cast<uint64_t>(rowCount({})))
         return -1;
-
-    return *it;
+    return *row;
 }
 
 void LogTableModel::setColumnWidths(std::vector<seer::ColumnWidth> widths) {
@@ -237,13 +268,16 @@ QVariant LogTableModel::headerData(int section, Qt::Orientation orientation, int
     if (role == (int)HeaderDataRole::LongestColumnIndex) {
         return rowCount({}) > 0 ? _columns[section].maxWidth.index : -1;
     }
+    if (role == (int)HeaderDataRole::IsOrdered) {
+        return _columns[section].ordered;
+    }
     return QVariant();
 }
 
 int LogTableModel::rowCount([[maybe_unused]] const QModelIndex& parent) const {
     if (!_index)
         return _parser->lineCount();
-    return _index->getLineCount();
+    return _rowCount;
 }
 
 int LogTableModel::unfilteredRowCount() const {
@@ -18,6 +18,8 @@ struct ColumnInfo {
     QString name;
     bool indexed = false;
     bool autosize = false;
+    // the parser orders the values, so ranges of them make sense
+    bool ordered = false;
     bool filterActive = false;
     seer::ColumnWidth maxWidth;
 };
@@ -27,7 +29,8 @@ enum class HeaderDataRole {
     IsFilterActive,
     FirstLine,
     IsAutosize,
-    LongestColumnIndex
+    LongestColumnIndex,
+    IsOrdered
 };
 
 struct RowSelection {
@@ -94,6 +97,10 @@ class LogTableModel : public QAbstractTableModel {
     Q_OBJECT;
 
     seer::Index* _index = nullptr;
+    int _rowCount = 0;
+    // the line offsets of the rows last prefetched for painting
+    uint64_t _prefetchedFirstRow = 0;
+    std::vector<uint64_t> _prefetchedRows;
     seer::FileParser* _parser;
     std::unique_ptr<seer::ILineParserContext> _parserContext;
     std::vector<ColumnInfo> _columns;
@@ -104,6 +111,10 @@ class LogTableModel : public QAbstractTableModel {
     SelectionTracker _selectedChar;
     bool _selectionExtended = true;
 
+    void readLines(uint64_t begin,
+                   uint64_t end,
+                   std::function<void(uint64_t, const std::string&)> accept);
+
 public:
     using LineHandler = std::function<void(const std::string&)>;
 
@@ -111,10 +122,14 @@ public:
     void invalidate();
     void setFilterActive(int column, bool active);
     void setIndex(seer::Index* index);
+    // picks up lines appended to the index since the last call while it is still being searched
+    void appendRows();
     void showIndexedColumns();
     void copyRawLines(uint64_t begin, uint64_t end, LineHandler accept);
     void copyLines(uint64_t begin, uint64_t end, LineHandler accept);
     uint64_t lineOffset(uint64_t row) const;
+    // maps the rows about to be painted in a single pass over the line map
+    void prefetchRows(int first, int count);
     int findRow(uint64_t lineOffset);
     void setColumnWidths(std::vector<seer::ColumnWidth> widths);
     virtual int rowCount(const QModelIndex& parent) const override;
@@ -61,7 +61,18 @@ void handleStateChanged(LogFile* file,
         searchLine->setSearchButtonTitle(SearchButtonTitle::Abort);
     } else if (file->isState(sm::CompleteState)) {
         table->setModel(file->logTableModel());
+        std::vector<std::pair<int, std::string>> indexedColumns;
+        auto formats = file->lineParser()->getColumnFormats();
+        for (auto i = 0; i < static_cast<int>(formats.size()); ++i) {
+            if (formats[i].indexed) {
+                indexedColumns.push_back({i, formats[i].header});
+            }
+        }
+        searchLine->setColumns(indexedColumns);
         auto status = searchModel ? fmt::format("{} matches found", searchModel->rowCount({})) : "";
+        if (auto skipped = file->searchRegexLimitHits()) {
+            status += fmt::format(", {} lines skipped (the regex is too complex)", skipped);
+        }
         searchLine->setStatus(status);
         searchLine->setProgress(-1);
         searchLine->setSearchEnabled(true);
@@ -372,6 +383,24 @@ void MainWindow::openLog(std::string path, std::string parser) {
         });
     });
 
+    connect(file.get(),
+            &LogFile::searchResultsChanged,
+            this,
+            [=, file = file.get()] {
+        table->setHist(file->searchHist());
+        auto matches = file->searchLogTableModel()->rowCount({});
+        searchLine->setStatus(fmt::format("Searching... {} matches so far", matches));
+    });
+
+    connect(file.get(),
+            &LogFile::findFinished,
+            this,
+            [=] (bool found) {
+        if (!found) {
+            searchLine->setStatus("No more matches");
+        }
+    });
+
     connect(file.get(),
             &LogFile::progressChanged,
             this,
@@ -426,18 +455,38 @@ void MainWindow::openLog(std::string path, std::string parser) {
         &SearchLine::searchRequested,
         this,
         [=, file = file.get()](
-            std::string text, bool regex, bool caseSensitive, bool unicodeAware, bool messageOnly) {
+            std::string text,
+            bool regex,
+            bool caseSensitive,
+            bool unicodeAware,
+            bool messageOnly,
+            int column) {
             if (text.empty()) {
                 table->setHist(nullptr);
                 searchTable->setModel(nullptr);
                 searchLine->setStatus("");
             } else {
-                file->search(text, regex, caseSensitive, unicodeAware, messageOnly);
+                file->search(text, regex, caseSensitive, unicodeAware, messageOnly, column);
             }
             searchTable->setSearchHighlight(text, regex, caseSensitive, unicodeAware, messageOnly);
             table->setSearchHighlight(text, regex, caseSensitive, unicodeAware, messageOnly);
         });
 
+    connect(
+        searchLine,
+        &SearchLine::findRequested,
+        this,
+        [=, file = file.get()](
+            std::string text,
+            bool regex,
+            bool caseSensitive,
+            bool unicodeAware,
+            bool messageOnly,
+            bool backward) {
+            table->setSearchHighlight(text, regex, caseSensitive, unicodeAware, messageOnly);
+            file->find(text, regex, caseSensitive, unicodeAware, messageOnly, backward);
+        });
+
     connect(
         file.get(),
         &LogFile::filterRequested,
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "gui/grid/LruCache.h"
+#include "seer/FilterAlgo.h"
+#include "seer/Hist.h"
+#include "seer/Index.h"
+#include <boost/container_hash/hash.hpp>
+#include <map>
+#include <set>
+#include <string>
+#include <memory>
+
+namespace gui {
+
+struct SearchCacheKey {
+    std::string text;
+    bool regex = false;
+    bool caseSensitive = false;
+    bool unicodeAware = false;
+    bool messageOnly = false;
+    int column = -1;
+    std::map<int, seer::ColumnFilter> filters;
+
+    bool operator==(SearchCacheKey const& other) const = default;
+};
+
+// the hash is a fingerprint of the query and the active filters, the key itself is compared on a hit
+struct SearchCacheKeyHash {
+    size_t operator()(const SearchCacheKey& key) const {
+        size_t seed = 0;
+        boost::hash_combine(seed, key.text);
+        boost::hash_combine(seed, key.regex);
+        boost::hash_combine(seed, key.caseSensitive);
+        boost::hash_combine(seed, key.unicodeAware);
+        boost::hash_combine(seed, key.messageOnly);
+        boost::hash_combine(seed, key.column);
+        for (const auto& [column, filter] : key.filters) {
+            boost::hash_combine(seed, column);
+            boost::hash_combine(seed, filter.exclude);
+            boost::hash_range(seed, filter.selected.begin(), filter.selected.end());
+        }
+        return seed;
+    }
+};
+
+struct SearchCacheEntry {
+    ewah_bitset lines;
+    std::shared_ptr<seer::Hist> hist;
+    uint64_t regexLimitHits = 0;
+
+    size_t sizeInBytes() const {
+        return lines.sizeInBytes() + hist->sizeInBytes();
+    }
+};
+
+// completed search results weighted by their size in bytes
+using SearchCache = LruCache<SearchCacheKey, std::shared_ptr<const SearchCacheEntry>, SearchCacheKeyHash>;
+
+} // namespace gui
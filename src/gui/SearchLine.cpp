@@ -40,6 +40,11 @@ SearchLine::SearchLine(bool regexInitial,
     unicodeAware->setChecked(unicodeAwareInitial);
     unicodeAware->setText("Unicode");
 
+    _column = new QComboBox();
+    _column->addItem("All columns", -1);
+    _column->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+    _column->hide();
+
     _status = new QLabel();
     _progress = new QProgressBar();
     _progress->setMaximum(100);
@@ -49,6 +54,7 @@ SearchLine::SearchLine(bool regexInitial,
     bottomHbox->addWidget(_status);
     bottomHbox->addWidget(_progress);
     bottomHbox->addStretch();
+    bottomHbox->addWidget(_column);
     bottomHbox->addWidget(regex);
     bottomHbox->addWidget(caseSensitive);
     bottomHbox->addWidget(messageOnly);
@@ -77,9 +83,26 @@ SearchLine::SearchLine(bool regexInitial,
                              regex->isChecked(),
                              caseSensitive->isChecked(),
                              unicodeAware->isChecked(),
-                             messageOnly->isChecked());
+                             messageOnly->isChecked(),
+                             _column->currentData().toInt());
+    };
+
+    auto find = [=, this](bool backward) {
+        if (edit->text().isEmpty())
+            return;
+        emit findRequested(edit->text().toStdString(),
+                           regex->isChecked(),
+                           caseSensitive->isChecked(),
+                           unicodeAware->isChecked(),
+                           messageOnly->isChecked(),
+                           backward);
     };
 
+    auto findNextShortcut = new QShortcut(QKeySequence(Qt::Key_F3), this);
+    auto findPreviousShortcut = new QShortcut(QKeySequence(Qt::SHIFT | Qt::Key_F3), this);
+    connect(findNextShortcut, &QShortcut::activated, this, [=] { find(false); });
+    connect(findPreviousShortcut, &QShortcut::activated, this, [=] { find(true); });
+
     connect(edit, &QLineEdit::returnPressed, this, search);
     connect(_button, &QPushButton::clicked, this, search);
     connect(regex, &QCheckBox::clicked, this, &SearchLine::regexChanged);
@@ -108,4 +131,23 @@ void SearchLine::setSearchEnabled(bool enabled) {
     _button->setEnabled(enabled);
 }
 
+void SearchLine::setColumns(const std::vector<std::pair<int, std::string>>& columns) {
+    auto same = _column->count() == static_cast<int>(columns.size()) + 1;
+    for (auto i = 0; same && i < static_cast<int>(columns.size()); ++i) {
+        same = _column->itemData(i + 1).toInt() == columns[i].first
+            && _column->itemText(i + 1).toStdString() == columns[i].second;
+    }
+    if (same)
+        return;
+
+    _column->setCurrentIndex(0);
+    while (_column->count() > 1) {
+        _column->removeItem(1);
+    }
+    for (const auto& [column, header] : columns) {
+        _column->addItem(QString::fromStdString(header), column);
+    }
+    _column->setVisible(!columns.empty());
+}
+
 } // namespace gui
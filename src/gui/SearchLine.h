@@ -5,6 +5,9 @@
 #include <QProgressBar>
 #include <QLabel>
 #include <QPushButton>
+#include <QComboBox>
+#include <vector>
+#include <utility>
 
 namespace gui {
 
@@ -19,6 +22,7 @@ class SearchLine : public QWidget {
     QLabel* _status;
     QProgressBar* _progress;
     QPushButton* _button;
+    QComboBox* _column;
 
 public:
     SearchLine(bool regexInitial,
@@ -30,13 +34,22 @@ public:
     void setSearchButtonTitle(SearchButtonTitle title);
     void setProgress(int progress);
     void setSearchEnabled(bool enabled);
+    // the indexed columns a search can be limited to, as column index and header pairs
+    void setColumns(const std::vector<std::pair<int, std::string>>& columns);
 
 signals:
     void searchRequested(std::string string,
                          bool regex,
                          bool caseSensitive,
                          bool unicodeAware,
-                         bool messageOnly);
+                         bool messageOnly,
+                         int column);
+    void findRequested(std::string string,
+                       bool regex,
+                       bool caseSensitive,
+                       bool unicodeAware,
+                       bool messageOnly,
+                       bool backward);
     void regexChanged(bool regex);
     void caseSensitiveChanged(bool caseSensitive);
     void messageOnlyChanged(bool messageOnly);
@@ -4,26 +4,34 @@
 #include "gui/grid/LruCache.h"
 #include "gui/grid/RowColumn.h"
 
-#include <boost/icl/interval_set.hpp>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
 
 namespace gui::grid {
 
-class CachedHighlightSearcher {
-    using Set = boost::icl::interval_set<uint64_t>;
+// [first, last) byte ranges of the matches in a UTF-8 text, ordered and not overlapping
+using HighlightRanges = std::vector<std::tuple<int, int>>;
+
+void findHighlightRanges(seer::ISearcher& searcher,
+                         const std::string& text,
+                         HighlightRanges& ranges);
 
+class CachedHighlightSearcher {
     struct Entry {
-        Set set;
+        HighlightRanges ranges;
 #ifndef NDEBUG
-        QString text;
+        std::string text;
 #endif
     };
-    std::unique_ptr<seer::IHighlightSearcher> _searcher;
+    std::unique_ptr<seer::ISearcher> _searcher;
     LruCache<RowColumn, std::shared_ptr<Entry>, RowColumnHash> _cache;
 
 public:
-    explicit CachedHighlightSearcher(std::unique_ptr<seer::IHighlightSearcher> searcher,
+    explicit CachedHighlightSearcher(std::unique_ptr<seer::ISearcher> searcher,
                                      size_t cacheSize);
-    std::tuple<int, int> search(QString text, size_t start, int row, int column);
+    std::shared_ptr<const HighlightRanges> search(const std::string& text, int row, int column);
     void invalidateCache();
 };
 
@@ -95,6 +95,12 @@ void LogTable::setModel(LogTableModel* model) {
         _view->invalidateCache();
     });
 
+    connect(_model, &QAbstractTableModel::rowsInserted, this, [this] {
+        _scrollArea->setRowCount(_model->rowCount({}));
+        _scrollArea->update();
+        _view->update();
+    });
+
     connect(_model, &LogTableModel::selectionChanged, this, [this] {
         if (auto selection = _model->getRowSelection()) {
             if (!_scrollArea->isVisible(selection->first) &&
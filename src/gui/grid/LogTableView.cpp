@@ -74,10 +74,9 @@ void LogTableView::paintRow(QPainter* painter, int row, int y) {
         painter->fillRect(r, b);
     }
 
-    std::unique_ptr<seer::IHighlightSearcher> selectionSearcher;
+    CachedHighlightSearcher* selectionSearcher = nullptr;
     if (columnSelection) {
-        auto text = getSelectionText(*columnSelection);
-        selectionSearcher = seer::createHighlightSearcher(text, false, false, true);
+        selectionSearcher = getSelectionSearcher(*columnSelection);
     }
 
     constexpr int regularGrapheme = 0;
@@ -130,29 +129,31 @@ void LogTableView::paintRow(QPainter* painter, int row, int y) {
         }
 
         auto isMessageColumn = column == columns - 1;
-        bool shouldApplySearcher =
-            (_cachedSearcher && (isMessageColumn || !_messageOnlyHighlight)) || selectionSearcher;
-        if (shouldApplySearcher) {
-            auto search = [&] (int index) {
-                if (selectionSearcher)
-                    return selectionSearcher->search(text, index);
-                return _cachedSearcher->search(text, index, row, column);
-            };
-            int currentIndex = std::get<0>(gmap->graphemeToIndexRange(searchRange.first));
-            while (currentIndex < searchRange.last) {
-                auto [first, len] = search(currentIndex);
-                if (first == -1 || len == 0)
-                    break;
-
-                auto last = std::min(first + len - 1, searchRange.last);
-
+        const HighlightRanges* ranges = nullptr;
+        std::shared_ptr<const HighlightRanges> cachedRanges;
+        if (selectionSearcher) {
+            cachedRanges = selectionSearcher->search(gmap->utf8(), row, column);
+            ranges = cachedRanges.get();
+        } else if (_cachedSearcher && (isMessageColumn || !_messageOnlyHighlight)) {
+            cachedRanges = _cachedSearcher->search(gmap->utf8(), row, column);
+            ranges = cachedRanges.get();
+        }
+        if (ranges) {
+            auto firstByte = gmap->graphemeToByte(searchRange.first);
+            auto lastByte = gmap->graphemeToByte(searchRange.last + 1);
+            auto it = std::lower_bound(
+                begin(*ranges), end(*ranges), firstByte, [](const auto& range, int byte) {
+                    return std::get<1>(range) <= byte;
+                });
+            for (; it != end(*ranges) && std::get<0>(*it) < lastByte; ++it) {
+                auto first = gmap->byteToGrapheme(std::max(std::get<0>(*it), firstByte));
+                auto last = gmap->byteToGrapheme(std::min(std::get<1>(*it), lastByte) - 1);
                 for (int i = first; i <= last; ++i) {
-                    auto grapheme = gmap->indexToGrapheme(i) - searchRange.first;
+                    auto grapheme = i - searchRange.first;
                     if (rowSelection || !(graphemes.at(grapheme) & selectedGrapheme)) {
                         graphemes.at(grapheme) |= highlightedGrapheme;
                     }
                 }
-                currentIndex += len;
             }
         }
 
@@ -312,6 +313,21 @@ void LogTableView::addColumnExcludeActions(int column, int row, QMenu& menu) {
     menu.addSeparator();
     menu.addAction(excludeAction);
     menu.addAction(includeAction);
+
+    auto isOrdered = model->headerData(column, Qt::Horizontal, (int)HeaderDataRole::IsOrdered).toBool();
+    if (isOrdered) {
+        auto fromAction = new QAction(QString("Include from: %0").arg(columnValue));
+        connect(fromAction, &QAction::triggered, [=] {
+            logFile->includeValueRange(column, columnValue.toStdString(), {});
+        });
+        auto upToAction = new QAction(QString("Include up to: %0").arg(columnValue));
+        connect(upToAction, &QAction::triggered, [=] {
+            logFile->includeValueRange(column, {}, columnValue.toStdString());
+        });
+        menu.addAction(fromAction);
+        menu.addAction(upToAction);
+    }
+
     menu.addAction(clearFilterAction);
 }
 
@@ -424,6 +440,7 @@ void LogTableView::paintEvent(QPaintEvent* event) {
     int y = 0;
 
     int maxY = event->rect().height() + _rowHeight;
+    model->prefetchRows(row, maxY / _rowHeight + 2);
     for (; row < _table->model()->rowCount(QModelIndex()); ++row) {
         painter.save();
         paintRow(&painter, row, y);
@@ -490,13 +507,11 @@ void LogTableView::setSearchHighlight(std::string text,
                                       bool unicodeAware,
                                       bool messageOnly) {
     _messageOnlyHighlight = messageOnly;
-    auto qText = QString::fromStdString(text);
     if (text.empty())
         _cachedSearcher.reset();
     else
         _cachedSearcher.emplace(
-            seer::createHighlightSearcher(qText, regex, caseSensitive, unicodeAware),
-            g_gmapCacheSize);
+            seer::createSearcher(text, regex, caseSensitive, unicodeAware), g_gmapCacheSize);
     update();
 }
 
@@ -521,10 +536,22 @@ QString LogTableView::getSelectionText(const ColumnSelection& columnSelection) {
     return gmap->line().mid(ileft, iright - ileft + 1);
 }
 
+CachedHighlightSearcher* LogTableView::getSelectionSearcher(
+    const ColumnSelection& columnSelection) {
+    auto text = getSelectionText(columnSelection).toStdString();
+    if (!_selectionSearcher || text != _selectionSearcherText) {
+        _selectionSearcher.emplace(seer::createSearcher(text, false, false, true),
+                                   g_gmapCacheSize);
+        _selectionSearcherText = std::move(text);
+    }
+    return &*_selectionSearcher;
+}
+
 void LogTableView::invalidateCache() {
     _gmapCache.clear();
     if (_cachedSearcher)
         _cachedSearcher->invalidateCache();
+    _selectionSearcher.reset();
 }
 
 } // namespace gui::grid
@@ -40,6 +40,8 @@ class LogTableView : public QWidget {
     int _rowHeight;
     int _firstRow = 0;
     std::optional<CachedHighlightSearcher> _cachedSearcher;
+    std::optional<CachedHighlightSearcher> _selectionSearcher;
+    std::string _selectionSearcherText;
     bool _messageOnlyHighlight = false;
     bool _selectWords = false;
     std::unique_ptr<IFontMetrics> _gmapFontMetrics;
@@ -51,6 +53,7 @@ class LogTableView : public QWidget {
     void addColumnExcludeActions(int column, int row, QMenu& menu);
     void addClearAllFiltersAction(QMenu& menu);
     std::shared_ptr<GraphemeMap> getGraphemeMap(int row, int column);
+    CachedHighlightSearcher* getSelectionSearcher(const ColumnSelection& columnSelection);
 
 public:
     explicit LogTableView(QFont font, LogTable* parent);
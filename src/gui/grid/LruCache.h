@@ -10,13 +10,24 @@ template<typename T, typename Key>
 struct Entry {
     typename std::list<Key>::iterator iter;
     T elem;
+    size_t weight;
 };
 
 template<typename Key, typename T, typename KeyHash>
 class LruCache {
     std::unordered_map<Key, Entry<T, Key>, KeyHash> _map;
     std::list<Key> _lru;
-    int _capacity;
+    size_t _capacity;
+    size_t _weight = 0;
+
+    void evict() {
+        while (_weight > _capacity && !_lru.empty()) {
+            auto it = _map.find(_lru.back());
+            _lru.pop_back();
+            _weight -= it->second.weight;
+            _map.erase(it);
+        }
+    }
 
 public:
     LruCache(size_t capacity) : _capacity(capacity) { }
@@ -31,40 +42,52 @@ public:
         return it->second.elem;
     }
 
-    void insert(Key key, T elem) {
+    // the capacity is shared by the weights of the elements, one per element by default;
+    // an element heavier than the whole capacity isn't cached rather than evicting everything
+    void insert(Key key, T elem, size_t weight = 1) {
+        if (weight > _capacity)
+            return;
         auto it = _map.find(key);
         if (it == end(_map)) {
             _lru.push_front(key);
-            _map[key] = { begin(_lru), elem };
+            _map[key] = { begin(_lru), elem, weight };
+            _weight += weight;
         } else {
             _lru.erase(it->second.iter);
             _lru.push_front(key);
             it->second.iter = begin(_lru);
         }
-        if ((int)_map.size() > _capacity) { // TODO: ssize
-            auto lru = _lru.back();
-            _lru.pop_back();
-            _map.erase(_map.find(lru));
-        }
+        evict();
     }
 
     bool erase(Key key) {
         auto it = _map.find(key);
         if (it != end(_map)) {
             _lru.erase(it->second.iter);
+            _weight -= it->second.weight;
             _map.erase(it);
             return true;
         }
         return false;
     }
 
-    void setCapacity(int capacity) {
+    size_t size() const {
+        return _map.size();
+    }
+
+    size_t weight() const {
+        return _weight;
+    }
+
+    void setCapacity(size_t capacity) {
         _capacity = capacity;
+        evict();
     }
 
     void clear() {
         _lru.clear();
         _map.clear();
+        _weight = 0;
     }
 };
 
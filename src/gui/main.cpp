@@ -4,6 +4,7 @@
 #include "seer/CommandLineParser.h"
 #include "seer/InstanceTracker.h"
 #include "seer/Log.h"
+#include "seer/Searcher.h"
 
 #include <QApplication>
 #include <QStyleFactory>
@@ -16,6 +17,8 @@ int main(int argc, char *argv[]) {
             seer::log_enable(parser.fileLog());
         }
         gui::g_Config.init();
+        seer::setRegexEngine(gui::g_Config.generalConfig().dfaRegex ? seer::RegexEngine::Dfa
+                                                                     : seer::RegexEngine::Backtracking);
 
         if (!parser.help().empty()) {
             std::cout << parser.help() << std::endl;
@@ -14,6 +14,7 @@ struct SearchEvent {
     bool caseSensitive;
     bool unicodeAware;
     bool messageOnly;
+    int column = -1;
 };
 struct InterruptEvent {};
 struct ReloadEvent {
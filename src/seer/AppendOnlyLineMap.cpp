@@ -0,0 +1,32 @@
+#include "AppendOnlyLineMap.h"
+
+namespace seer {
+
+AppendOnlyLineMap::AppendOnlyLineMap(unsigned bucketSize) : _lines(bucketSize) {}
+
+void AppendOnlyLineMap::add(uint64_t value) {
+    auto lock = std::lock_guard(_mutex);
+    _lines.add(value);
+}
+
+uint64_t AppendOnlyLineMap::get(uint64_t index) {
+    auto lock = std::lock_guard(_mutex);
+    return _lines.get(index);
+}
+
+void AppendOnlyLineMap::getRange(uint64_t index, std::span<uint64_t> values) {
+    auto lock = std::lock_guard(_mutex);
+    _lines.getRange(index, values);
+}
+
+uint64_t AppendOnlyLineMap::size() const {
+    auto lock = std::lock_guard(_mutex);
+    return _lines.size();
+}
+
+ewah::EWAHBoolArray<uint64_t> AppendOnlyLineMap::bitset() const {
+    auto lock = std::lock_guard(_mutex);
+    return _lines.bitset();
+}
+
+} // namespace seer
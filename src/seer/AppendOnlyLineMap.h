@@ -0,0 +1,23 @@
+#pragma once
+
+#include "RandomBitArray.h"
+#include <mutex>
+
+namespace seer {
+
+// A line map that a search keeps appending to while the lines found so far are already being
+// displayed from another thread.
+class AppendOnlyLineMap : public IRandomArray {
+    mutable std::mutex _mutex;
+    RandomBitArray _lines;
+
+public:
+    AppendOnlyLineMap(unsigned bucketSize);
+    void add(uint64_t value);
+    uint64_t get(uint64_t index) override;
+    void getRange(uint64_t index, std::span<uint64_t> values) override;
+    uint64_t size() const override;
+    ewah::EWAHBoolArray<uint64_t> bitset() const;
+};
+
+} // namespace seer
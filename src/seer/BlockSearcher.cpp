@@ -0,0 +1,80 @@
+#include "BlockSearcher.h"
+
+#include "FileParser.h"
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+namespace seer {
+
+constexpr uint64_t g_searchBlockSize = 4 << 20;
+
+BlockSearcher::BlockSearcher(FileParser* fileParser, std::string pattern)
+    : _fileParser(fileParser),
+      _pattern(pattern),
+      _searcher(begin(_pattern), end(_pattern)) {}
+
+bool BlockSearcher::canSearch(FileParser* fileParser, const std::string& pattern) {
+    return fileParser->hasRawLines()
+        && !pattern.empty()
+        && pattern.find_first_of(std::string("\n\0", 2)) == std::string::npos;
+}
+
+size_t BlockSearcher::find(const std::string& buffer, size_t pos) const {
+    if (_pattern.size() == 1) {
+        auto found = memchr(&buffer[pos], _pattern[0], buffer.size() - pos);
+        return found ? static_cast<const char*>(found) - buffer.data() : std::string::npos;
+    }
+    auto found = std::search(begin(buffer) + pos, end(buffer), _searcher);
+    return found == end(buffer) ? std::string::npos : found - begin(buffer);
+}
+
+bool BlockSearcher::search(std::function<void(uint64_t)> onLine,
+                           std::function<bool()> stopRequested,
+                           std::function<void(uint64_t, uint64_t)> progress) {
+    auto lineCount = _fileParser->lineCount();
+    uint64_t delta = _fileParser->lineOffsetDelta();
+    std::string buffer;
+    std::vector<uint64_t> groups;
+
+    uint64_t first = 0;
+    while (first < lineCount) {
+        if (stopRequested())
+            return false;
+
+        // a block consists of whole groups of delta lines, whose offsets are known exactly
+        auto start = _fileParser->lineOffset(first);
+        groups.clear();
+        auto last = first;
+        uint64_t size = 0;
+        while (last < lineCount && size < g_searchBlockSize) {
+            groups.push_back(size);
+            last = std::min(last + delta, lineCount);
+            size = _fileParser->lineOffset(last) - start;
+        }
+
+        buffer.resize(size);
+        _fileParser->readBlock(start, buffer);
+
+        size_t pos = 0;
+        while (pos < buffer.size() && (pos = find(buffer, pos)) != std::string::npos) {
+            auto group = std::upper_bound(begin(groups), end(groups), pos) - begin(groups) - 1;
+            auto groupStart = begin(buffer) + groups[group];
+            auto line = first + group * delta + std::count(groupStart, begin(buffer) + pos, '\n');
+            onLine(line);
+
+            auto eol = memchr(&buffer[pos], '\n', buffer.size() - pos);
+            if (!eol)
+                break;
+            pos = static_cast<const char*>(eol) - buffer.data() + 1;
+        }
+
+        if (progress)
+            progress(last - 1, lineCount);
+
+        first = last;
+    }
+    return true;
+}
+
+} // namespace seer
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <stdint.h>
+
+namespace seer {
+
+class FileParser;
+
+// Scans the file in large blocks for a literal pattern instead of reading and matching lines one
+// by one. Match positions are mapped to line numbers through the sampled line offsets.
+class BlockSearcher {
+    FileParser* _fileParser;
+    std::string _pattern;
+    std::boyer_moore_horspool_searcher<std::string::const_iterator> _searcher;
+
+    size_t find(const std::string& buffer, size_t pos) const;
+
+public:
+    BlockSearcher(FileParser* fileParser, std::string pattern);
+    BlockSearcher(const BlockSearcher&) = delete;
+    BlockSearcher& operator=(const BlockSearcher&) = delete;
+    static bool canSearch(FileParser* fileParser, const std::string& pattern);
+    bool search(std::function<void(uint64_t)> onLine,
+                std::function<bool()> stopRequested,
+                std::function<void(uint64_t, uint64_t)> progress);
+};
+
+} // namespace seer
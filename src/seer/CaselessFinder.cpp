@@ -0,0 +1,136 @@
+#include "CaselessFinder.h"
+
+#include <assert.h>
+#include <bit>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SEER_CASELESS_SSE2
+#endif
+
+namespace seer {
+
+namespace {
+
+constexpr uint64_t g_ones = 0x0101010101010101;
+
+unsigned char fold(char ch) {
+    auto c = static_cast<unsigned char>(ch);
+    return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+unsigned char upper(unsigned char c) {
+    return c >= 'a' && c <= 'z' ? c & ~0x20 : c;
+}
+
+// sets 0x20 in every byte of the word that is an ASCII upper case letter
+uint64_t foldWord(uint64_t word) {
+    auto low = word & (0x7f * g_ones);
+    auto aboveA = low + (0x80 - 'A') * g_ones;
+    auto aboveZ = low + (0x80 - 'Z' - 1) * g_ones;
+    auto upper = aboveA & ~aboveZ & ~word & (0x80 * g_ones);
+    return word | (upper >> 2);
+}
+
+#ifndef SEER_CASELESS_SSE2
+// sets 0x80 in every zero byte of the word
+uint64_t zeroBytes(uint64_t word) {
+    auto low = word & (0x7f * g_ones);
+    return ~((low + 0x7f * g_ones) | word | (0x7f * g_ones));
+}
+#endif
+
+uint64_t load(const char* ptr) {
+    uint64_t word;
+    memcpy(&word, ptr, sizeof(word));
+    return word;
+}
+
+} // namespace
+
+CaselessFinder::CaselessFinder(std::string_view pattern) {
+    assert(!pattern.empty());
+    for (auto ch : pattern) {
+        _folded.push_back(fold(ch));
+    }
+}
+
+bool CaselessFinder::equal(const char* text) const {
+    auto pattern = _folded.data();
+    auto size = _folded.size();
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        if (foldWord(load(text + i)) != load(pattern + i))
+            return false;
+    }
+    for (; i < size; ++i) {
+        if (fold(text[i]) != static_cast<unsigned char>(pattern[i]))
+            return false;
+    }
+    return true;
+}
+
+size_t CaselessFinder::find(std::string_view text, size_t pos) const {
+    auto size = _folded.size();
+    if (pos > text.size() || text.size() - pos < size)
+        return std::string_view::npos;
+    auto end = text.size() - size + 1;
+    auto data = text.data();
+    auto first = static_cast<unsigned char>(_folded.front());
+    auto last = static_cast<unsigned char>(_folded.back());
+
+    // a block of positions is checked at once for the first and the last byte of the pattern in
+    // either case, only the positions matching both are compared in full
+#ifdef SEER_CASELESS_SSE2
+    auto firstLower = _mm_set1_epi8(first);
+    auto firstUpper = _mm_set1_epi8(upper(first));
+    auto lastLower = _mm_set1_epi8(last);
+    auto lastUpper = _mm_set1_epi8(upper(last));
+    for (; pos + sizeof(__m128i) <= end; pos += sizeof(__m128i)) {
+        auto firstBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        auto lastBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + size - 1));
+        auto firstMatch = _mm_or_si128(_mm_cmpeq_epi8(firstBytes, firstLower),
+                                       _mm_cmpeq_epi8(firstBytes, firstUpper));
+        auto lastMatch = _mm_or_si128(_mm_cmpeq_epi8(lastBytes, lastLower),
+                                      _mm_cmpeq_epi8(lastBytes, lastUpper));
+        auto candidates = static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_and_si128(firstMatch, lastMatch)));
+        while (candidates) {
+            auto offset = std::countr_zero(candidates);
+            if (equal(data + pos + offset))
+                return pos + offset;
+            candidates &= candidates - 1;
+        }
+    }
+#else
+    auto firstLower = g_ones * first;
+    auto firstUpper = g_ones * upper(first);
+    auto lastLower = g_ones * last;
+    auto lastUpper = g_ones * upper(last);
+    for (; pos + sizeof(uint64_t) <= end; pos += sizeof(uint64_t)) {
+        auto firstBytes = load(data + pos);
+        auto lastBytes = load(data + pos + size - 1);
+        auto candidates =
+            (zeroBytes(firstBytes ^ firstLower) | zeroBytes(firstBytes ^ firstUpper))
+            & (zeroBytes(lastBytes ^ lastLower) | zeroBytes(lastBytes ^ lastUpper));
+        while (candidates) {
+            auto offset = std::countr_zero(candidates) / 8;
+            if (equal(data + pos + offset))
+                return pos + offset;
+            candidates &= candidates - 1;
+        }
+    }
+#endif
+    for (; pos < end; ++pos) {
+        if (fold(data[pos]) == first && equal(data + pos))
+            return pos;
+    }
+    return std::string_view::npos;
+}
+
+size_t CaselessFinder::size() const {
+    return _folded.size();
+}
+
+} // namespace seer
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <stdint.h>
+
+namespace seer {
+
+// Finds a literal folding ASCII letters, the way a caseless PCRE2 pattern does without PCRE2_UTF.
+// Other bytes are compared as they are. Candidates are found sixteen positions at a time with SSE2,
+// or eight with plain word arithmetic elsewhere.
+class CaselessFinder {
+    std::string _folded;
+
+    bool equal(const char* text) const;
+
+public:
+    explicit CaselessFinder(std::string_view pattern);
+    size_t find(std::string_view text, size_t pos) const;
+    size_t size() const;
+};
+
+} // namespace seer
@@ -8,6 +8,8 @@
 
 namespace seer {
 
+constexpr int g_lineOffsetDelta = 32;
+
 void FileParser::initConverter() {
     _stream->seekg(0);
     std::string line;
@@ -79,7 +81,7 @@ void FileParser::index(std::function<void(uint64_t, uint64_t)> progress,
     _indexed = true;
     std::string line;
     uint64_t index = 0;
-    _lineOffsets.reset(32, [this](uint64_t offset) {
+    _lineOffsets.reset(g_lineOffsetDelta, [this](uint64_t offset) {
         _stream->seekg(offset);
         std::string line;
         std::getline(*_stream, line);
@@ -90,6 +92,7 @@ void FileParser::index(std::function<void(uint64_t, uint64_t)> progress,
 
     _stream->seekg(0, std::ios_base::end);
     auto fileSize = _stream->tellg();
+    _fileSize = fileSize;
     _stream->seekg(0);
 
     _stream->ignore(_bomSize);
@@ -155,6 +158,33 @@ void FileParser::readLine(uint64_t index, std::string& line) {
     _currentIndex++;
 }
 
+// UTF-8 lines are stored as is and can be searched in place, without reading them one by one
+bool FileParser::hasRawLines() const {
+    return !_convert && !_eolLeftPadding && !_eolRightPadding;
+}
+
+int FileParser::lineOffsetDelta() const {
+    return g_lineOffsetDelta;
+}
+
+// cheap for multiples of lineOffsetDelta(), lineCount() maps to the end of the file
+uint64_t FileParser::lineOffset(uint64_t index) {
+    auto lock = std::lock_guard(_mutex);
+    assert(index < _lineOffsets.size());
+    if (index == _lineOffsets.size() - 1)
+        return _fileSize;
+    return _lineOffsets.map(index);
+}
+
+void FileParser::readBlock(uint64_t offset, std::string& buffer) {
+    auto lock = std::lock_guard(_mutex);
+    _stream->seekg(offset);
+    _stream->read(&buffer[0], buffer.size());
+    buffer.resize(_stream->gcount());
+    _stream->clear();
+    _currentIndex = -1;
+}
+
 ILineParser* FileParser::lineParser() const {
     return _lineParser;
 }
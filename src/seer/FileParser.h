@@ -25,6 +25,7 @@ class FileParser {
     int _eolLeftPadding = 0;
     int _eolRightPadding = 0;
     int _handleZeros = true;
+    uint64_t _fileSize = 0;
 
     void initConverter();
 
@@ -35,6 +36,10 @@ public:
                std::function<bool()> stopRequested = []{ return false; });
     uint64_t lineCount();
     void readLine(uint64_t index, std::string& line);
+    bool hasRawLines() const;
+    int lineOffsetDelta() const;
+    uint64_t lineOffset(uint64_t index);
+    void readBlock(uint64_t offset, std::string& buffer);
     ILineParser* lineParser() const;
     size_t calcLineIndexSize() const;
 };
@@ -1,13 +1,58 @@
 #include "FilterAlgo.h"
+#include "ParallelFor.h"
 
+#include <algorithm>
+#include <queue>
 #include <ranges>
+#include <tuple>
 
 namespace seer {
 
+ewah_bitset parallelOr(const std::vector<const ewah_bitset*>& sets, unsigned threadCount) {
+    if (sets.empty())
+        return {};
+    // fast_logicalor only reads the array
+    auto setPtrs = const_cast<const ewah_bitset**>(sets.data());
+    if (threadCount < 2 || sets.size() < g_parallelOrMinSets)
+        return fast_logicalor(sets.size(), setPtrs);
+
+    size_t totalSize = 0;
+    for (auto set : sets) {
+        totalSize += set->sizeInBytes();
+    }
+
+    // a group ends once it holds its share of the bytes, so that a few large sets don't make one
+    // thread do all the work
+    auto groupCount = std::min<size_t>(threadCount, sets.size() / (g_parallelOrMinSets / 2));
+    std::vector<size_t> bounds{0};
+    size_t size = 0;
+    for (auto i = 0u; i < sets.size() && bounds.size() < groupCount; ++i) {
+        size += sets[i]->sizeInBytes();
+        if (size * groupCount >= totalSize * bounds.size()) {
+            bounds.push_back(i + 1);
+        }
+    }
+    if (bounds.back() != sets.size()) {
+        bounds.push_back(sets.size());
+    }
+
+    std::vector<ewah_bitset> groups(bounds.size() - 1);
+    parallelForIndex(groups.size(), threadCount, 1, [&](size_t i) {
+        groups[i] = fast_logicalor(bounds[i + 1] - bounds[i], setPtrs + bounds[i]);
+    });
+
+    std::vector<const ewah_bitset*> groupPtrs;
+    for (auto& group : groups) {
+        groupPtrs.push_back(&group);
+    }
+    return fast_logicalor(groupPtrs.size(), &groupPtrs[0]);
+}
+
 FilterAlgo::FilterAlgo(const ewah_bitset& baseSet,
                        std::vector<const ewah_bitset*>& baseVec,
-                       std::vector<const ewah_bitset*>& newVec)
-    : _baseSet(baseSet), _newVec(newVec)
+                       std::vector<const ewah_bitset*>& newVec,
+                       unsigned threadCount)
+    : _baseSet(baseSet), _newVec(newVec), _threadCount(threadCount)
 {
     std::ranges::sort(baseVec);
     std::ranges::sort(newVec);
@@ -15,17 +60,75 @@ FilterAlgo::FilterAlgo(const ewah_bitset& baseSet,
     std::set_difference(begin(baseVec), end(baseVec), begin(newVec), end(newVec), std::back_inserter(_removed));
 }
 
+namespace {
+
+// the union of several sets is no larger than their sizes together nor than an uncompressed set of
+// as many bits as the largest one has
+size_t unionSize(size_t first, size_t second, size_t uncompressedSize) {
+    return std::min(first + second, uncompressedSize);
+}
+
+// fast_logicalor merges the two smallest sets first, every merge reads both sets and writes their
+// union; returns the cost and the expected size of the result
+std::tuple<size_t, size_t> orCost(const std::vector<const ewah_bitset*>& sets,
+                                  size_t uncompressedSize) {
+    std::priority_queue<size_t, std::vector<size_t>, std::greater<>> sizes;
+    for (auto set : sets) {
+        sizes.push(set->sizeInBytes());
+    }
+    if (sizes.empty())
+        return {0, 0};
+
+    size_t cost = 0;
+    while (sizes.size() > 1) {
+        auto first = sizes.top();
+        sizes.pop();
+        auto second = sizes.top();
+        sizes.pop();
+        auto merged = unionSize(first, second, uncompressedSize);
+        cost += first + second + merged;
+        sizes.push(merged);
+    }
+    return {cost, sizes.top()};
+}
+
+size_t maxSizeInBits(const std::vector<const ewah_bitset*>& sets) {
+    size_t bits = 0;
+    for (auto set : sets) {
+        bits = std::max(bits, set->sizeInBits());
+    }
+    return bits;
+}
+
+} // namespace
+
 FilterAlgoStats FilterAlgo::stats() const {
-    return {.naiveOps = _newVec.size(), .diffOps = 2 + _added.size() + _removed.size()};
+    auto bits = std::max({_baseSet.sizeInBits(), maxSizeInBits(_newVec), maxSizeInBits(_removed)});
+    auto uncompressedSize = (bits + 63) / 64 * sizeof(uint64_t);
+
+    auto [naiveCost, naiveSize] = orCost(_newVec, uncompressedSize);
+
+    // (base | added) - removed, the subtraction writes at most what it reads from the union
+    auto base = _baseSet.sizeInBytes();
+    auto [addedCost, addedSize] = orCost(_added, uncompressedSize);
+    auto [removedCost, removedSize] = orCost(_removed, uncompressedSize);
+    auto withAdded = unionSize(base, addedSize, uncompressedSize);
+    auto addCost = base + addedSize + withAdded;
+    auto removeCost = withAdded + removedSize + withAdded;
+
+    return {.naiveOps = _newVec.size(),
+            .diffOps = 2 + _added.size() + _removed.size(),
+            .naiveCost = naiveCost + naiveSize,
+            .diffCost = addedCost + removedCost + addCost + removeCost};
 }
 
 ewah_bitset FilterAlgo::naive() {
-    return fast_logicalor(_newVec.size(), &_newVec[0]);
+    return parallelOr(_newVec, _threadCount);
 }
 
 ewah_bitset FilterAlgo::diff() {
-    auto addedSet = fast_logicalor(_added.size(), &_added[0]);
-    auto removedSet = fast_logicalor(_removed.size(), &_removed[0]);
+    auto addedSet = parallelOr(_added, _threadCount);
+    auto removedSet = parallelOr(_removed, _threadCount);
     return (_baseSet | addedSet) - removedSet;
 }
 
@@ -7,9 +7,23 @@ using ewah_bitset = ewah::EWAHBoolArray<uint64_t>;
 
 namespace seer {
 
+// fewer sets are OR-ed on the calling thread
+inline constexpr size_t g_parallelOrMinSets = 64;
+
+// ORs the sets in a tree: groups of sets of about the same total size are OR-ed on their own
+// threads and the groups are OR-ed together
+ewah_bitset parallelOr(const std::vector<const ewah_bitset*>& sets, unsigned threadCount);
+
 struct FilterAlgoStats {
     size_t naiveOps{};
     size_t diffOps{};
+    // the compressed bytes each algorithm is expected to read and write
+    size_t naiveCost{};
+    size_t diffCost{};
+
+    bool preferNaive() const {
+        return naiveCost <= diffCost;
+    }
 };
 
 class FilterAlgo {
@@ -17,11 +31,13 @@ class FilterAlgo {
     std::vector<const ewah_bitset*>& _newVec;
     std::vector<const ewah_bitset*> _removed;
     std::vector<const ewah_bitset*> _added;
+    unsigned _threadCount;
 
 public:
     FilterAlgo(const ewah_bitset& baseSet,
                std::vector<const ewah_bitset*>& baseVec,
-               std::vector<const ewah_bitset*>& newVec);
+               std::vector<const ewah_bitset*>& newVec,
+               unsigned threadCount = 1);
 
     FilterAlgoStats stats() const;
     ewah_bitset naive();
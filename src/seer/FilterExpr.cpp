@@ -0,0 +1,185 @@
+#include "FilterExpr.h"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <assert.h>
+
+namespace seer {
+
+FilterExpr FilterExpr::columnValues(int column, std::set<std::string> values) {
+    return {.op = Op::Values, .column = column, .values = std::move(values)};
+}
+
+FilterExpr FilterExpr::lineSet(std::shared_ptr<const ewah_bitset> lines) {
+    assert(lines);
+    return {.op = Op::Lines, .lines = std::move(lines)};
+}
+
+FilterExpr FilterExpr::all(std::vector<FilterExpr> operands) {
+    return {.op = Op::And, .operands = std::move(operands)};
+}
+
+FilterExpr FilterExpr::any(std::vector<FilterExpr> operands) {
+    return {.op = Op::Or, .operands = std::move(operands)};
+}
+
+FilterExpr FilterExpr::negate(FilterExpr operand) {
+    return {.op = Op::Not, .operands = {std::move(operand)}};
+}
+
+FilterEvaluator::FilterEvaluator(uint64_t lineCount,
+                                 ValueLines valueLines,
+                                 ValueCount valueCount,
+                                 std::function<bool()> stopRequested)
+    : _lineCount(lineCount),
+      _valueLines(std::move(valueLines)),
+      _valueCount(std::move(valueCount)),
+      _stopRequested(std::move(stopRequested)) {}
+
+ewah_bitset FilterEvaluator::complement(ewah_bitset lines) const {
+    if (lines.sizeInBits() < _lineCount) {
+        lines.padWithZeroes(_lineCount);
+    }
+    lines.inplace_logicalnot();
+    return lines;
+}
+
+uint64_t FilterEvaluator::estimate(const FilterExpr& expr) const {
+    switch (expr.op) {
+    case FilterExpr::Op::Values:
+        return _valueCount(expr.column, expr.values);
+    case FilterExpr::Op::Lines:
+        return expr.lines->numberOfOnes();
+    case FilterExpr::Op::Not: {
+        // only the counts of the leaves are exact, the complement of a bound is not a bound
+        auto& operand = expr.operands[0];
+        if (operand.op != FilterExpr::Op::Values && operand.op != FilterExpr::Op::Lines)
+            return _lineCount;
+        return _lineCount - std::min(_lineCount, estimate(operand));
+    }
+    case FilterExpr::Op::And: {
+        uint64_t result = _lineCount;
+        for (auto& operand : expr.operands) {
+            result = std::min(result, estimate(operand));
+        }
+        return result;
+    }
+    case FilterExpr::Op::Or: {
+        uint64_t result = 0;
+        for (auto& operand : expr.operands) {
+            result += estimate(operand);
+        }
+        return std::min(result, _lineCount);
+    }
+    }
+    assert(false);
+    return _lineCount;
+}
+
+std::optional<ewah_bitset> FilterEvaluator::evaluate(const FilterExpr& expr) {
+    if (_stopRequested())
+        return {};
+
+    switch (expr.op) {
+    case FilterExpr::Op::Values:
+        return _valueLines(expr.column, expr.values);
+    case FilterExpr::Op::Lines:
+        return *expr.lines;
+    case FilterExpr::Op::Not: {
+        auto lines = evaluate(expr.operands[0]);
+        if (!lines)
+            return {};
+        return complement(std::move(*lines));
+    }
+    case FilterExpr::Op::And:
+        return evaluateAll(expr);
+    case FilterExpr::Op::Or:
+        return evaluateAny(expr);
+    }
+    assert(false);
+    return {};
+}
+
+std::optional<ewah_bitset> FilterEvaluator::evaluateAll(const FilterExpr& expr) {
+    std::vector<std::tuple<uint64_t, const FilterExpr*>> included;
+    std::vector<std::tuple<uint64_t, const FilterExpr*>> excluded;
+    for (auto& operand : expr.operands) {
+        if (operand.op == FilterExpr::Op::Not) {
+            auto& negated = operand.operands[0];
+            excluded.emplace_back(estimate(negated), &negated);
+        } else {
+            included.emplace_back(estimate(operand), &operand);
+        }
+    }
+
+    // the smallest operands are intersected first and the largest are subtracted first, both
+    // shrink the intermediate result the most
+    std::ranges::sort(included, std::less{}, [](auto& t) { return std::get<0>(t); });
+    std::ranges::sort(excluded, std::greater{}, [](auto& t) { return std::get<0>(t); });
+
+    std::optional<ewah_bitset> result;
+    if (included.empty()) {
+        result = complement({});
+    } else {
+        result = evaluate(*std::get<1>(included[0]));
+    }
+
+    for (auto i = 1u; i < included.size(); ++i) {
+        if (!result || result->numberOfOnes() == 0)
+            return result;
+        auto lines = evaluate(*std::get<1>(included[i]));
+        if (!lines)
+            return {};
+        result = *result & *lines;
+    }
+
+    for (auto& [_, negated] : excluded) {
+        if (!result || result->numberOfOnes() == 0)
+            return result;
+        auto lines = evaluate(*negated);
+        if (!lines)
+            return {};
+        result = *result - *lines;
+    }
+
+    return result;
+}
+
+std::optional<ewah_bitset> FilterEvaluator::evaluateAny(const FilterExpr& expr) {
+    if (expr.operands.empty())
+        return ewah_bitset{};
+
+    // the values of the same column are looked up together instead of one leaf at a time
+    std::map<int, std::set<std::string>> columnValues;
+    std::vector<const FilterExpr*> others;
+    for (auto& operand : expr.operands) {
+        if (operand.op == FilterExpr::Op::Values) {
+            columnValues[operand.column].insert(begin(operand.values), end(operand.values));
+        } else {
+            others.push_back(&operand);
+        }
+    }
+
+    std::vector<ewah_bitset> operands;
+    operands.reserve(columnValues.size() + others.size());
+    for (auto& [column, values] : columnValues) {
+        if (_stopRequested())
+            return {};
+        operands.push_back(_valueLines(column, values));
+    }
+    for (auto operand : others) {
+        auto lines = evaluate(*operand);
+        if (!lines)
+            return {};
+        operands.push_back(std::move(*lines));
+    }
+
+    std::vector<const ewah_bitset*> pointers;
+    for (auto& lines : operands) {
+        pointers.push_back(&lines);
+    }
+    return fast_logicalor(pointers.size(), pointers.data());
+}
+
+} // namespace seer
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "FilterAlgo.h"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace seer {
+
+// A boolean filter over the lines of a file. The leaves are the lines having one of several
+// values in a column or a fixed set of lines such as search results.
+struct FilterExpr {
+    enum class Op { Values, Lines, And, Or, Not };
+
+    Op op = Op::And;
+    int column = -1;
+    std::set<std::string> values;
+    std::shared_ptr<const ewah_bitset> lines;
+    std::vector<FilterExpr> operands;
+
+    static FilterExpr columnValues(int column, std::set<std::string> values);
+    static FilterExpr lineSet(std::shared_ptr<const ewah_bitset> lines);
+    // an AND without operands is every line, an OR without operands is none
+    static FilterExpr all(std::vector<FilterExpr> operands);
+    static FilterExpr any(std::vector<FilterExpr> operands);
+    static FilterExpr negate(FilterExpr operand);
+};
+
+// Evaluates an expression over the per-value bitmaps. The operands of an AND are intersected from
+// the smallest estimated one so that an empty intermediate result ends the evaluation early, and
+// negated operands are subtracted instead of being complemented. The value leaves of an OR are
+// merged per column.
+class FilterEvaluator {
+public:
+    using ValueLines = std::function<ewah_bitset(int column, const std::set<std::string>& values)>;
+    using ValueCount = std::function<uint64_t(int column, const std::set<std::string>& values)>;
+
+private:
+    uint64_t _lineCount;
+    ValueLines _valueLines;
+    ValueCount _valueCount;
+    std::function<bool()> _stopRequested;
+
+    ewah_bitset complement(ewah_bitset lines) const;
+    std::optional<ewah_bitset> evaluateAll(const FilterExpr& expr);
+    std::optional<ewah_bitset> evaluateAny(const FilterExpr& expr);
+
+public:
+    FilterEvaluator(uint64_t lineCount,
+                    ValueLines valueLines,
+                    ValueCount valueCount,
+                    std::function<bool()> stopRequested = [] { return false; });
+    // returns nothing when stopped
+    std::optional<ewah_bitset> evaluate(const FilterExpr& expr);
+    // an upper bound of the number of lines the expression leaves, exact for the leaves and their
+    // negations
+    uint64_t estimate(const FilterExpr& expr) const;
+};
+
+} // namespace seer
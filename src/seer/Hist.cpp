@@ -1,7 +1,5 @@
 #include "Hist.h"
 
-#include <assert.h>
-
 namespace {
 
 int scale(int n, int size, int newSize) {
@@ -18,8 +16,8 @@ void Hist::add(int n, int count) {
     _hist[scale(n, count, _hist.size())].fetch_add(1, std::memory_order_relaxed);
 }
 
+// can be called while the search is still adding to the bins
 int Hist::get(int n, int count) const {
-    assert(_frozen);
     auto first = scale(n, count, _hist.size());
     auto last = std::min(scale(n + 1, count, _hist.size()) - 1, (int)_hist.size() - 1);
     int sum = 0;
@@ -33,4 +31,8 @@ void Hist::freeze() {
     _frozen = true;
 }
 
+size_t Hist::sizeInBytes() const {
+    return _hist.size() * sizeof(decltype(_hist)::value_type);
+}
+
 } // namespace seer
@@ -15,6 +15,7 @@ public:
     void add(int n, int count);
     int get(int n, int count) const;
     void freeze();
+    size_t sizeInBytes() const;
 };
 
 } // namespace seer
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ValueOrder.h"
 #include <string>
 #include <string_view>
 #include <vector>
@@ -12,6 +13,7 @@ struct ColumnFormat {
     std::string header;
     bool indexed;
     bool autosize;
+    ValueOrder order = {};
 };
 
 class ILineParserContext {
@@ -24,10 +26,21 @@ public:
     virtual bool parseLine(std::string_view line,
                            std::vector<std::string>& columns,
                            ILineParserContext& context) = 0;
+    virtual void parseLines(const std::vector<std::string_view>& lines,
+                            std::vector<std::vector<std::string>>& columns,
+                            std::vector<bool>& parsed,
+                            ILineParserContext& context) {
+        columns.resize(lines.size());
+        parsed.resize(lines.size());
+        for (auto i = 0u; i < lines.size(); ++i) {
+            parsed[i] = parseLine(lines[i], columns[i], context);
+        }
+    }
     virtual std::vector<ColumnFormat> getColumnFormats() = 0;
     virtual bool isMatch(const std::vector<std::string>& sample, std::string_view fileName) = 0;
     virtual std::string name() const = 0;
     virtual uint32_t rgb(std::vector<std::string> const&) const { return 0; }
+    virtual bool trigramIndex() const { return false; }
     virtual std::unique_ptr<ILineParserContext> createContext() const = 0;
     virtual ~ILineParser() = default;
 };
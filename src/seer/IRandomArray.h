@@ -1,14 +1,44 @@
 #pragma once
 
 #include "stdint.h"
+#include <optional>
+#include <span>
 
 namespace seer {
 
+// An increasing sequence of values, such as the lines a filter or a search keeps.
 class IRandomArray {
 public:
     virtual ~IRandomArray() = default;
     virtual uint64_t get(uint64_t index) = 0;
     virtual uint64_t size() const = 0;
+
+    // fills values with the consecutive values starting at index, arrays that would otherwise
+    // locate every value from scratch position themselves once and iterate
+    virtual void getRange(uint64_t index, std::span<uint64_t> values) {
+        for (auto& value : values) {
+            value = get(index++);
+        }
+    }
+
+    // the index of the value if it is in the array, a binary search over get() unless the array
+    // can count the values below it directly
+    virtual std::optional<uint64_t> indexOf(uint64_t value) {
+        uint64_t first = 0;
+        uint64_t count = size();
+        while (count > 0) {
+            auto step = count / 2;
+            if (get(first + step) < value) {
+                first += step + 1;
+                count -= step + 1;
+            } else {
+                count = step;
+            }
+        }
+        if (first == size() || get(first) != value)
+            return {};
+        return first;
+    }
 };
 
 } // namespace seer
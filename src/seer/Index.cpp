@@ -1,12 +1,17 @@
 #include "Index.h"
 
+#include "AppendOnlyLineMap.h"
+#include "BlockSearcher.h"
 #include "Log.h"
+#include "MultiLiteralSearcher.h"
 #include "ParallelFor.h"
 #include "SPMCQueue.h"
 #include "Searcher.h"
 #include "Stopwatch.h"
+#include "TrigramIndex.h"
 #include <fmt/chrono.h>
 #include <QString>
+#include <map>
 #include <numeric>
 #include <optional>
 #include <thread>
@@ -19,11 +24,23 @@ constexpr float g_maxFailureRatio = .1f;
 constexpr int g_producerBatchSize = 1000;
 constexpr int g_consumerBatchSize = 200;
 constexpr int g_stringPoolSize = g_producerBatchSize;
+constexpr int g_searchChunkSize = 4096;
+constexpr uint64_t g_minParallelSearchLines = 4 * g_searchChunkSize;
+constexpr uint64_t g_maxBlockSearchSparsity = 16;
+constexpr size_t g_valueCountChunkSize = 256;
 
 int lineLength(const std::string& line) {
     return line.size();
 }
 
+unsigned workerCount(unsigned maxThreads) {
+    auto threadCount = std::thread::hardware_concurrency();
+    if (maxThreads) {
+        threadCount = std::min(maxThreads, threadCount);
+    }
+    return std::max(threadCount, 1u);
+}
+
 template <class T>
 class Pool {
     moodycamel::ConcurrentQueue<T> _queue;
@@ -69,33 +86,37 @@ class Indexer {
     std::function<bool()> _stopRequested;
     std::function<void(uint64_t, uint64_t)> _progress;
     std::vector<ColumnInfo>* _columns;
+    TrigramIndex* _trigrams;
     SPMCQueue<QueueItemPtr> _queue;
     Pool<QueueItemPtr> _stringPool;
     std::vector<Result> _results;
     std::vector<std::thread> _threads;
     std::vector<ewah_bitset> _failures;
+    std::vector<TrigramIndex> _threadTrigrams;
     ewah_bitset _combinedFailures;
 
     void prepareThreads() {
-        auto threadCount = std::thread::hardware_concurrency();
-        if (_maxThreads) {
-            threadCount = std::min(_maxThreads, threadCount);
-        }
+        auto threadCount = workerCount(_maxThreads);
 
         Result emptyIndex;
         for (auto format : _lineParser->getColumnFormats()) {
-            emptyIndex.push_back({{}, format.indexed, {}, {}, {}});
+            emptyIndex.push_back({{}, format.indexed, {}});
         }
 
         _results = {threadCount, emptyIndex};
         _threads.resize(threadCount);
         _failures.resize(threadCount);
+        if (_trigrams) {
+            _threadTrigrams.resize(threadCount);
+        }
 
         *_columns = emptyIndex;
     }
 
     void threadBody(int id, ILineParserContext& lineParserContext) {
-        std::vector<std::string> columns;
+        std::vector<std::string_view> lines;
+        std::vector<std::vector<std::string>> rows;
+        std::vector<bool> parsed;
         [[maybe_unused]] int lastLineIndex = 0;
         auto lastColumn = _lineParser->getColumnFormats().size() - 1;
         std::vector<QueueItemPtr> items(g_consumerBatchSize);
@@ -105,12 +126,22 @@ class Indexer {
             if (!size)
                 return;
 
+            lines.clear();
+            for (auto i = 0; i < size; ++i) {
+                lines.push_back(items[i]->line);
+            }
+            _lineParser->parseLines(lines, rows, parsed, lineParserContext);
+
             for (auto i = 0; i < size; ++i) {
                 auto& [line, lineIndex] = *items[i];
                 assert(lineIndex >= lastLineIndex);
                 lastLineIndex = lineIndex;
                 auto& index = _results[id];
-                if (_lineParser->parseLine(line, columns, lineParserContext)) {
+                if (_trigrams) {
+                    _threadTrigrams[id].add(lineIndex, line);
+                }
+                if (parsed[i]) {
+                    auto& columns = rows[i];
                     for (auto i = 0u; i < columns.size(); ++i) {
                         index[i].maxWidth = std::max(index[i].maxWidth, {lineIndex, lineLength(columns[i])});
                         if (index[i].indexed) {
@@ -158,8 +189,13 @@ class Indexer {
                 _progress(pos, fileSize);
             }
         }, [&] (const auto& line) {
-            if (parsingOnly)
+            if (parsingOnly) {
+                // nothing is parsed for a single column, only its trigrams are indexed
+                if (_trigrams) {
+                    _trigrams->add(lineNumber++, line);
+                }
                 return;
+            }
             if (itemsPos == items.size()) {
                 _queue.enqueue(&items[0], items.size());
                 items.resize(g_producerBatchSize);
@@ -193,7 +229,7 @@ class Indexer {
 
         Result columnInfos;
         for (auto format : _lineParser->getColumnFormats()) {
-            columnInfos.push_back({{}, format.indexed, {}, {}, {}});
+            columnInfos.push_back({{}, format.indexed, {}});
         }
         std::vector<std::string> columns;
         auto failures = _combinedFailures.toArray();
@@ -291,6 +327,21 @@ class Indexer {
         log_infof("bitsets: {}, total size: {:.2f} MB",
                   count,
                   static_cast<double>(totalSize) / (1 << 20));
+
+        if (_trigrams) {
+            log_infof("trigram index: {} postings, {:.2f} MB",
+                      _trigrams->postingCount(),
+                      static_cast<double>(_trigrams->sizeInBytes()) / (1 << 20));
+        }
+    }
+
+    void reduceTrigrams() {
+        if (!_trigrams)
+            return;
+        for (auto& trigrams : _threadTrigrams) {
+            _trigrams->merge(trigrams);
+        }
+        _threadTrigrams.clear();
     }
 
 public:
@@ -299,13 +350,15 @@ public:
             unsigned maxThreads,
             std::function<bool()> stopRequested,
             std::function<void(uint64_t, uint64_t)> progress,
-            std::vector<ColumnInfo>* columns)
+            std::vector<ColumnInfo>* columns,
+            TrigramIndex* trigrams)
         : _fileParser(fileParser),
           _lineParser(lineParser),
           _maxThreads(maxThreads),
           _stopRequested(stopRequested),
           _progress(progress),
-          _columns(columns) {}
+          _columns(columns),
+          _trigrams(trigrams) {}
 
     bool index() {
         auto columnFormats = _lineParser->getColumnFormats();
@@ -318,6 +371,7 @@ public:
             if (!pushLinesToThreads(true))
                 return false;
             log_info("parsing done");
+            logIndexSize();
             return true;
         }
 
@@ -337,6 +391,7 @@ public:
         log_info("consolidating indexes");
 
         reduceIndexes();
+        reduceTrigrams();
 
         log_info("indexing multilines");
 
@@ -351,71 +406,540 @@ public:
     }
 };
 
-void Index::makePerColumnIndex(std::vector<ColumnFilter>::const_iterator first,
-                               std::vector<ColumnFilter>::const_iterator last) {
-    for (auto filter = first; filter != last; ++filter) {
-        std::vector<const ewah_bitset*> perValue;
-        auto& column = _columns[filter->column];
-        assert(column.indexed);
-        for (auto& value : filter->selected) {
-            perValue.push_back(&column.index[value]);
+class LineMatcher {
+    ILineParser* _lineParser;
+    std::unique_ptr<ISearcher> _searcher;
+    std::unique_ptr<ILineParserContext> _context;
+    std::vector<std::string> _columns;
+    bool _messageOnly;
+
+public:
+    LineMatcher(ILineParser* lineParser,
+                const std::string& text,
+                bool regex,
+                bool caseSensitive,
+                bool unicodeAware,
+                bool messageOnly)
+        : _lineParser(lineParser),
+          _searcher(createSearcher(text, regex, caseSensitive, unicodeAware)),
+          _context(lineParser->createContext()),
+          _messageOnly(messageOnly) {}
+
+    bool match(const std::string& line) {
+        auto lineToSearch = &line;
+        if (_messageOnly) {
+            _columns.clear();
+            _lineParser->parseLine(line, _columns, *_context);
+            if (!_columns.empty()) {
+                lineToSearch = &_columns.back();
+            }
         }
+        return std::get<0>(_searcher->search(*lineToSearch, 0)) != -1;
+    }
+
+    uint64_t limitHits() const {
+        return _searcher->limitHits();
+    }
+};
+
+// Matches a line against several queries at once. Literal queries looking at the same text with the
+// same case sensitivity share one automaton, the others are matched one by one.
+class MultiQueryMatcher {
+    struct LiteralGroup {
+        bool messageOnly;
+        MultiLiteralSearcher searcher;
+        std::vector<int> queries;
+    };
+
+    struct OtherQuery {
+        int query;
+        bool messageOnly;
+        std::unique_ptr<ISearcher> searcher;
+    };
 
-        std::vector<const ewah_bitset*> oldSelectedSets;
-        for (auto& valueName : column.selectedValues) {
-            oldSelectedSets.push_back(&column.index[valueName]);
+    ILineParser* _lineParser;
+    std::unique_ptr<ILineParserContext> _context;
+    std::vector<LiteralGroup> _groups;
+    std::vector<OtherQuery> _others;
+    bool _needsMessage = false;
+    std::vector<std::string> _columns;
+    std::vector<char> _found;
+
+public:
+    MultiQueryMatcher(ILineParser* lineParser, const std::vector<SearchQuery>& queries)
+        : _lineParser(lineParser), _context(lineParser->createContext()) {
+        for (auto messageOnly : {false, true}) {
+            for (auto caseSensitive : {false, true}) {
+                std::vector<std::string> patterns;
+                std::vector<int> literalQueries;
+                for (auto i = 0u; i < queries.size(); ++i) {
+                    auto& query = queries[i];
+                    // the automaton folds ASCII case only
+                    auto literal = !query.regex && !query.text.empty()
+                                && (query.caseSensitive || !query.unicodeAware);
+                    if (literal && query.messageOnly == messageOnly
+                                && query.caseSensitive == caseSensitive) {
+                        patterns.push_back(query.text);
+                        literalQueries.push_back(i);
+                    }
+                }
+                if (!patterns.empty()) {
+                    _groups.push_back({messageOnly,
+                                       MultiLiteralSearcher(patterns, caseSensitive),
+                                       literalQueries});
+                }
+            }
         }
 
-        Stopwatch sw;
+        for (auto i = 0u; i < queries.size(); ++i) {
+            auto& query = queries[i];
+            auto literal = !query.regex && !query.text.empty()
+                        && (query.caseSensitive || !query.unicodeAware);
+            if (!literal) {
+                _others.push_back({static_cast<int>(i),
+                                   query.messageOnly,
+                                   createSearcher(query.text,
+                                                  query.regex,
+                                                  query.caseSensitive,
+                                                  query.unicodeAware)});
+            }
+            _needsMessage |= query.messageOnly;
+        }
+    }
+
+    // sets matches[i] if the line matches query i
+    void match(const std::string& line, std::vector<char>& matches) {
+        std::string_view message = line;
+        if (_needsMessage) {
+            _columns.clear();
+            _lineParser->parseLine(line, _columns, *_context);
+            if (!_columns.empty()) {
+                message = _columns.back();
+            }
+        }
+
+        for (auto& group : _groups) {
+            group.searcher.search(group.messageOnly ? message : line, _found);
+            for (auto i = 0u; i < _found.size(); ++i) {
+                matches[group.queries[i]] = _found[i];
+            }
+        }
+
+        for (auto& other : _others) {
+            auto& text = other.messageOnly && !_columns.empty() ? _columns.back() : line;
+            matches[other.query] = std::get<0>(other.searcher->search(text, 0)) != -1;
+        }
+    }
+
+    size_t literalGroupCount() const {
+        return _groups.size();
+    }
+
+    // the lines each query skipped because its regex hit the match limit, literals never do
+    std::vector<uint64_t> limitHits(size_t queryCount) const {
+        std::vector<uint64_t> hits(queryCount);
+        for (auto& other : _others) {
+            hits[other.query] = other.searcher->limitHits();
+        }
+        return hits;
+    }
+};
+
+// Lines are read sequentially on the calling thread and handed out to the workers in chunks.
+// Chunks may complete out of order, they are merged into the line map by id.
+class ParallelSearcher {
+    struct Chunk {
+        uint64_t id = 0;
+        uint64_t histIndex = 0;
+        int size = 0;
+        std::vector<uint64_t> indices = std::vector<uint64_t>(g_searchChunkSize);
+        std::vector<std::string> lines = std::vector<std::string>(g_searchChunkSize);
+        std::vector<uint64_t> matches;
+    };
+
+    using ChunkPtr = std::unique_ptr<Chunk>;
+
+    FileParser* _fileParser;
+    AppendOnlyLineMap* _lineMap;
+    Hist& _hist;
+    uint64_t _histSize;
+    uint64_t _lineCount;
+    std::function<bool()> _stopRequested;
+    std::function<void(uint64_t, uint64_t)> _progress;
+    std::vector<LineMatcher>& _matchers;
+    std::vector<std::thread> _threads;
+    moodycamel::BlockingConcurrentQueue<ChunkPtr> _chunks;
+    moodycamel::BlockingConcurrentQueue<ChunkPtr> _results;
+    std::atomic<bool> _stopped = false;
+    std::vector<ChunkPtr> _freeChunks;
+    std::map<uint64_t, ChunkPtr> _pending;
+    uint64_t _nextChunkId = 0;
+    uint64_t _nextMergeId = 0;
+
+    void threadBody(LineMatcher& matcher) {
+        ChunkPtr chunk;
+        for (;;) {
+            _chunks.wait_dequeue(chunk);
+            if (!chunk)
+                return;
+
+            chunk->matches.clear();
+            for (auto i = 0; i < chunk->size && !_stopped; ++i) {
+                if (matcher.match(chunk->lines[i])) {
+                    chunk->matches.push_back(chunk->indices[i]);
+                    _hist.add(chunk->histIndex + i, _histSize);
+                }
+            }
+            _results.enqueue(std::move(chunk));
+        }
+    }
+
+    void startThreads() {
+        _threads.resize(_matchers.size());
+        for (auto i = 0u; i < _threads.size(); ++i) {
+            _threads[i] = std::thread([this, &matcher = _matchers[i]] { threadBody(matcher); });
+        }
+        for (auto i = 0u; i < 2 * _threads.size(); ++i) {
+            _freeChunks.push_back(std::make_unique<Chunk>());
+        }
+    }
+
+    void stopThreads() {
+        for ([[maybe_unused]] auto& th : _threads) {
+            _chunks.enqueue(ChunkPtr());
+        }
+        for (auto& th : _threads) {
+            th.join();
+        }
+    }
+
+    void merge(ChunkPtr chunk) {
+        auto id = chunk->id;
+        _pending[id] = std::move(chunk);
+        for (auto it = _pending.find(_nextMergeId); it != end(_pending);
+             it = _pending.find(_nextMergeId)) {
+            auto& ready = it->second;
+            for (auto index : ready->matches) {
+                _lineMap->add(index);
+            }
+            if (_progress && ready->size) {
+                _progress(ready->indices[ready->size - 1], _lineCount);
+            }
+            _freeChunks.push_back(std::move(ready));
+            _pending.erase(it);
+            _nextMergeId++;
+        }
+    }
+
+    void collect(bool wait) {
+        ChunkPtr chunk;
+        if (wait) {
+            _results.wait_dequeue(chunk);
+            merge(std::move(chunk));
+        }
+        while (_results.try_dequeue(chunk)) {
+            merge(std::move(chunk));
+        }
+    }
+
+    ChunkPtr takeChunk(uint64_t histIndex) {
+        collect(false);
+        while (_freeChunks.empty()) {
+            collect(true);
+        }
+        auto chunk = std::move(_freeChunks.back());
+        _freeChunks.pop_back();
+        chunk->id = _nextChunkId++;
+        chunk->histIndex = histIndex;
+        chunk->size = 0;
+        return chunk;
+    }
+
+public:
+    ParallelSearcher(FileParser* fileParser,
+                     AppendOnlyLineMap* lineMap,
+                     Hist& hist,
+                     uint64_t histSize,
+                     uint64_t lineCount,
+                     std::function<bool()> stopRequested,
+                     std::function<void(uint64_t, uint64_t)> progress,
+                     std::vector<LineMatcher>& matchers)
+        : _fileParser(fileParser),
+          _lineMap(lineMap),
+          _hist(hist),
+          _histSize(histSize),
+          _lineCount(lineCount),
+          _stopRequested(stopRequested),
+          _progress(progress),
+          _matchers(matchers) {}
+
+    template <class R>
+    bool search(const R& lines) {
+        startThreads();
+
+        uint64_t done = 0;
+        auto chunk = takeChunk(done);
+        for (auto index : lines) {
+            if (chunk->size == g_searchChunkSize) {
+                _chunks.enqueue(std::move(chunk));
+                if (_stopRequested()) {
+                    _stopped = true;
+                    stopThreads();
+                    return false;
+                }
+                chunk = takeChunk(done);
+            }
+            _fileParser->readLine(index, chunk->lines[chunk->size]);
+            chunk->indices[chunk->size++] = index;
+            done++;
+        }
+        _chunks.enqueue(std::move(chunk));
+
+        while (_nextMergeId != _nextChunkId) {
+            collect(true);
+        }
+
+        stopThreads();
+        return true;
+    }
+};
+
+template <class It>
+struct IteratorRange {
+    It first;
+    It last;
+
+    It begin() const {
+        return first;
+    }
+
+    It end() const {
+        return last;
+    }
+};
+
+// the columns are shared, a value that isn't in the column has no lines instead of being added
+const ewah_bitset& valueLines(const ColumnInfo& column, const std::string& value) {
+    static const ewah_bitset empty;
+    auto it = column.index.find(value);
+    return it == end(column.index) ? empty : it->second;
+}
+
+const ewah_bitset& Index::columnIndex(int columnIndex,
+                                      const std::set<std::string>& selected,
+                                      unsigned maxThreads) {
+    auto& column = (*_columns)[columnIndex];
+    auto& columnSelection = _selections[columnIndex];
+    assert(column.indexed);
+    if (columnSelection && columnSelection->values == selected)
+        return columnSelection->lines;
+
+    std::vector<const ewah_bitset*> perValue;
+    for (auto& value : selected) {
+        perValue.push_back(&valueLines(column, value));
+    }
 
-        FilterAlgo algo(column.currentIndex, oldSelectedSets, perValue);
-        auto stats = algo.stats();
-        auto useNaive = stats.naiveOps <= stats.diffOps;
-        column.currentIndex = useNaive ? algo.naive() : algo.diff();
+    std::vector<const ewah_bitset*> oldSelectedSets;
+    ewah_bitset emptySet;
+    const ewah_bitset* baseSet = &emptySet;
+    if (columnSelection) {
+        baseSet = &columnSelection->lines;
+        for (auto& valueName : columnSelection->values) {
+            oldSelectedSets.push_back(&valueLines(column, valueName));
+        }
+    }
+
+    Stopwatch sw;
 
-        log_infof("filtered column {} using {} algorithm ({} vs {}) in {}",
-                  filter - first,
-                  useNaive ? "naive" : "diff",
-                  stats.naiveOps,
-                  stats.diffOps,
-                  sw.msElapsed());
+    // the previous selection may be shared with a filter snapshot, so a new one replaces it
+    FilterAlgo algo(*baseSet, oldSelectedSets, perValue, workerCount(maxThreads));
+    auto stats = algo.stats();
+    auto useNaive = stats.preferNaive();
+    auto selection = std::make_shared<ColumnSelection>();
+    selection->lines = useNaive ? algo.naive() : algo.diff();
+    selection->values = selected;
+
+    // the costs next to the time it took are what validates the model
+    log_infof("filtered column {} using {} algorithm (cost {} naive, {} diff, {} vs {} ops) in {}",
+              columnIndex,
+              useNaive ? "naive" : "diff",
+              stats.naiveCost,
+              stats.diffCost,
+              stats.naiveOps,
+              stats.diffOps,
+              sw.msElapsed());
+
+    columnSelection = selection;
+    return selection->lines;
+}
 
-        column.selectedValues = filter->selected;
+uint64_t Index::countValues(int column, const std::set<std::string>& values) const {
+    auto& index = _columns->at(column).index;
+    uint64_t count = 0;
+    for (auto& value : values) {
+        if (auto it = index.find(value); it != end(index)) {
+            count += it->second.numberOfOnes();
+        }
     }
+    return count;
+}
+
+ewah_bitset Index::filterLines(const ColumnFilter& filter, unsigned maxThreads) {
+    auto& lines = columnIndex(filter.column, filter.selected, maxThreads);
+    if (!filter.exclude)
+        return lines;
+    ewah_bitset all;
+    all.padWithZeroes(_unfilteredLineCount);
+    all.inplace_logicalnot();
+    return all - lines;
 }
 
 Index::Index(uint64_t unfilteredLineCount)
     : _unfilteredLineCount(unfilteredLineCount) {}
 
-void Index::filter(const std::vector<ColumnFilter>& filters) {
+bool Index::filter(const std::vector<ColumnFilter>& filters,
+                   std::function<bool()> stopRequested,
+                   unsigned maxThreads) {
     _filters = filters;
+    _expression.reset();
 
     if (filters.empty()) {
+        _values.clear();
         _filtered = false;
-        return;
+        return true;
     }
 
+    // an exclusion is subtracted from what the other filters leave, or from every line
+    std::vector<FilterExpr> operands;
+    for (auto& filter : filters) {
+        auto values = FilterExpr::columnValues(filter.column, filter.selected);
+        operands.push_back(filter.exclude ? FilterExpr::negate(std::move(values)) : values);
+    }
+    return applyFilter(FilterExpr::all(std::move(operands)), stopRequested, maxThreads);
+}
+
+bool Index::filterExpression(const FilterExpr& expression,
+                             std::function<bool()> stopRequested,
+                             unsigned maxThreads) {
+    _filters.clear();
+    _expression = expression;
+    return applyFilter(expression, stopRequested, maxThreads);
+}
+
+bool Index::applyFilter(const FilterExpr& expression,
+                        std::function<bool()> stopRequested,
+                        unsigned maxThreads) {
+    _values.clear();
     _filtered = true;
 
     log_info("started filtering");
 
-    makePerColumnIndex(begin(filters), end(filters));
-    _filter = _columns[_filters[0].column].currentIndex;
-    for (auto it = begin(_filters) + 1; it != end(_filters); ++it) {
-        _filter = _filter & _columns[it->column].currentIndex;
-    }
+    FilterEvaluator evaluator(
+        _unfilteredLineCount,
+        [=, this](int column, auto& values) { return columnIndex(column, values, maxThreads); },
+        [this](int column, auto& values) { return countValues(column, values); },
+        stopRequested);
+    auto lines = evaluator.evaluate(expression);
+    if (!lines)
+        return false;
+    _filter = std::make_shared<const ewah_bitset>(std::move(*lines));
 
     log_info("filtering complete");
 
+    if (stopRequested())
+        return false;
+
     Stopwatch sw;
-    auto iewah = std::make_shared<IndexedEwah>(2048);
-    iewah->init(_filter);
+    auto lineMap = std::make_shared<RankSelect>();
+    lineMap->init(*_filter);
 
     log_infof("done building lineMap in {} ({:.2f} MB)",
               sw.msElapsed(),
-              static_cast<double>(iewah->sizeInBytes()) / (1 << 20));
+              static_cast<double>(lineMap->sizeInBytes()) / (1 << 20));
+
+    _lineMap = std::move(lineMap);
+    return true;
+}
+
+bool Index::hasFilter() const {
+    return !_filters.empty() || _expression;
+}
+
+size_t valuesSizeInBytes(const std::set<std::string>& values) {
+    // a tree node holds the string next to three pointers and its color
+    size_t size = 0;
+    for (auto& value : values) {
+        size += 4 * sizeof(void*) + sizeof(value) + value.size();
+    }
+    return size;
+}
 
-    _lineMap = std::move(iewah);
+size_t ColumnFilter::sizeInBytes() const {
+    return sizeof(*this) + valuesSizeInBytes(selected);
+}
+
+static size_t expressionSizeInBytes(const FilterExpr& expression) {
+    size_t size = sizeof(expression) + valuesSizeInBytes(expression.values);
+    if (expression.lines) {
+        size += expression.lines->sizeInBytes();
+    }
+    for (auto& operand : expression.operands) {
+        size += expressionSizeInBytes(operand);
+    }
+    return size;
+}
+
+size_t FilterSnapshot::sizeInBytes() const {
+    size_t size = filter ? filter->sizeInBytes() : 0;
+    if (auto rankSelect = std::dynamic_pointer_cast<RankSelect>(lineMap)) {
+        size += rankSelect->sizeInBytes();
+    }
+    for (auto& columnFilter : filters) {
+        size += columnFilter.sizeInBytes();
+    }
+    if (expression) {
+        size += expressionSizeInBytes(*expression);
+    }
+    for (auto& selection : selections) {
+        if (selection) {
+            size += selection->lines.sizeInBytes() + valuesSizeInBytes(selection->values);
+        }
+    }
+    for (auto& [_, columnValues] : values) {
+        for (auto& value : *columnValues) {
+            size += sizeof(value) + value.value.size();
+        }
+    }
+    return size;
+}
+
+std::shared_ptr<const FilterSnapshot> Index::filterSnapshot() const {
+    auto snapshot = std::make_shared<FilterSnapshot>();
+    snapshot->filters = _filters;
+    snapshot->expression = _expression;
+    if (hasFilter()) {
+        snapshot->filter = _filter;
+        snapshot->lineMap = _lineMap;
+    }
+    snapshot->selections = _selections;
+    snapshot->values = _values;
+    return snapshot;
+}
+
+void Index::restoreFilter(const FilterSnapshot& snapshot) {
+    assert(snapshot.selections.size() == _selections.size());
+    _filters = snapshot.filters;
+    _expression = snapshot.expression;
+    _filter = snapshot.filter;
+    _lineMap = snapshot.lineMap;
+    _filtered = hasFilter();
+    // a selection is only where the next filter of its column starts, a newer one is as good
+    for (auto i = 0u; i < _selections.size(); ++i) {
+        if (snapshot.selections[i]) {
+            _selections[i] = snapshot.selections[i];
+        }
+    }
+    _values = snapshot.values;
 }
 
 bool Index::search(FileParser* fileParser,
@@ -426,58 +950,433 @@ bool Index::search(FileParser* fileParser,
                    bool messageOnly,
                    Hist& hist,
                    std::function<bool()> stopRequested,
-                   std::function<void(uint64_t, uint64_t)> progress)
+                   std::function<void(uint64_t, uint64_t)> progress,
+                   unsigned maxThreads,
+                   const ewah_bitset* scope)
+{
+    auto filtered = hasFilter();
+    auto lineCount = filtered ? _filter->numberOfOnes() : _unfilteredLineCount;
+
+    // a refined query only needs to look at the lines found by the previous one
+    auto scanLines = [&](const ewah_bitset& lines) {
+        return [&](auto onLine) {
+            for (auto index : lines) {
+                if (stopRequested())
+                    return false;
+                onLine(index);
+                if (progress)
+                    progress(index, _unfilteredLineCount);
+            }
+            return true;
+        };
+    };
+
+    if (scope) {
+        log_infof("searching within {} previous results", scope->numberOfOnes());
+        return searchCandidates(fileParser,
+                                text,
+                                regex,
+                                caseSensitive,
+                                unicodeAware,
+                                messageOnly,
+                                true,
+                                hist,
+                                scanLines(*scope));
+    }
+
+    // the trigram index folds ASCII case only
+    if (_trigrams && !regex && (caseSensitive || !unicodeAware)) {
+        if (auto candidates = _trigrams->candidates(text)) {
+            log_infof("verifying {} trigram candidates", candidates->numberOfOnes());
+            return searchCandidates(fileParser,
+                                    text,
+                                    false,
+                                    caseSensitive,
+                                    unicodeAware,
+                                    messageOnly,
+                                    true,
+                                    hist,
+                                    scanLines(*candidates));
+        }
+    }
+
+    // scanning whole blocks doesn't pay off when the filter leaves only a few lines to check
+    auto blockSearch = !regex && caseSensitive && BlockSearcher::canSearch(fileParser, text)
+                    && lineCount * g_maxBlockSearchSparsity >= _unfilteredLineCount;
+    if (blockSearch) {
+        log_infof("searching {} lines in blocks", lineCount);
+        return searchCandidates(
+            fileParser, text, false, true, false, messageOnly, false, hist,
+            [&](auto onLine) {
+                BlockSearcher searcher(fileParser, text);
+                return searcher.search(onLine, stopRequested, [&](auto index, auto) {
+                    if (progress)
+                        progress(index, _unfilteredLineCount);
+                });
+            });
+    }
+
+    auto threadCount = lineCount < g_minParallelSearchLines ? 1 : workerCount(maxThreads);
+
+    std::vector<LineMatcher> matchers;
+    for (auto i = 0u; i < threadCount; ++i) {
+        matchers.emplace_back(
+            fileParser->lineParser(), text, regex, caseSensitive, unicodeAware, messageOnly);
+    }
+
+    log_infof("searching {} lines using {} threads", lineCount, threadCount);
+
+    startSearch();
+    std::shared_ptr<int> guard(nullptr, [&](auto) {
+        uint64_t limitHits = 0;
+        for (auto& matcher : matchers) {
+            limitHits += matcher.limitHits();
+        }
+        finishSearch(hist, limitHits);
+    });
+
+    auto searchLines = [&](const auto& lines) {
+        if (threadCount > 1) {
+            ParallelSearcher searcher(fileParser,
+                                      _searchLineMap.get(),
+                                      hist,
+                                      lineCount,
+                                      _unfilteredLineCount,
+                                      stopRequested,
+                                      progress,
+                                      matchers);
+            return searcher.search(lines);
+        }
+
+        std::string line;
+        uint64_t done = 0;
+        for (auto index : lines) {
+            if (stopRequested())
+                return false;
+            fileParser->readLine(index, line);
+            if (matchers[0].match(line)) {
+                _searchLineMap->add(index);
+                hist.add(done, lineCount);
+            }
+            done++;
+            if (progress)
+                progress(index, _unfilteredLineCount);
+        }
+        return true;
+    };
+
+    if (filtered)
+        return searchLines(*_filter);
+
+    return searchLines(std::views::iota(uint64_t{0}, _unfilteredLineCount));
+}
+
+void Index::finishSearch(Hist& hist, uint64_t regexLimitHits) {
+    hist.freeze();
+    _regexLimitHits = regexLimitHits;
+    if (regexLimitHits) {
+        log_infof("{} lines hit the regex match limit and were skipped", regexLimitHits);
+    }
+}
+
+// the line map is published before scanning, so the lines found so far can be displayed while
+// the search is still running
+void Index::startSearch() {
+    _regexLimitHits = 0;
+    _searchLineMap = std::make_shared<AppendOnlyLineMap>(1024);
+    _lineMap = _searchLineMap;
+    _filtered = true;
+}
+
+std::optional<uint64_t> Index::find(FileParser* fileParser,
+                                    std::optional<uint64_t> row,
+                                    bool backward,
+                                    std::string text,
+                                    bool regex,
+                                    bool caseSensitive,
+                                    bool unicodeAware,
+                                    bool messageOnly,
+                                    std::function<bool()> stopRequested,
+                                    unsigned maxThreads)
 {
+    assert(!_searchLineMap);
     std::string line;
-    auto searcher = createSearcher(text, regex, caseSensitive, unicodeAware);
-    auto lineMap = std::make_shared<RandomBitArray>(1024);
-    std::vector<std::string> columns;
 
-    auto lineParserContext = fileParser->lineParser()->createContext();
+    auto threadCount = workerCount(maxThreads);
+    std::vector<LineMatcher> matchers;
+    for (auto i = 0u; i < threadCount; ++i) {
+        matchers.emplace_back(
+            fileParser->lineParser(), text, regex, caseSensitive, unicodeAware, messageOnly);
+    }
 
-    auto add = [&] (auto index, auto histIndex, auto histSize) {
-        fileParser->readLine(index, line);
-        auto lineToSearch = &line;
-        if (messageOnly) {
-            columns.clear();
-            fileParser->lineParser()->parseLine(line, columns, *lineParserContext);
-            if (!columns.empty()) {
-                lineToSearch = &columns.back();
+    // going backward, windows of rows are mapped at once, matched forward and the last match of
+    // the first window having one wins; a window gives every worker a chunk
+    if (backward) {
+        auto windowSize = static_cast<uint64_t>(g_searchChunkSize) * threadCount;
+        std::vector<uint64_t> window;
+        for (auto last = row ? *row : getLineCount(); last > 0;) {
+            if (stopRequested())
+                return {};
+            auto first = last - std::min(last, windowSize);
+            window.resize(last - first);
+            mapRange(first, window);
+            last = first;
+
+            if (threadCount > 1 && window.size() > g_searchChunkSize) {
+                AppendOnlyLineMap found(1024);
+                Hist hist(1);
+                ParallelSearcher searcher(fileParser,
+                                          &found,
+                                          hist,
+                                          window.size(),
+                                          _unfilteredLineCount,
+                                          stopRequested,
+                                          {},
+                                          matchers);
+                if (!searcher.search(window))
+                    return {};
+                if (found.size())
+                    return found.get(found.size() - 1);
+                continue;
+            }
+
+            for (auto index : window | std::views::reverse) {
+                fileParser->readLine(index, line);
+                if (matchers[0].match(line))
+                    return index;
             }
         }
-        if (std::get<0>(searcher->search(*lineToSearch, 0)) != -1) {
-            lineMap->add(index);
-            hist.add(histIndex, histSize);
+        return {};
+    }
+
+    auto findLines = [&](const auto& lines) -> std::optional<uint64_t> {
+        if (threadCount > 1) {
+            // chunks are merged in order, so the first merged match is the first one
+            AppendOnlyLineMap found(1);
+            Hist hist(1);
+            ParallelSearcher searcher(fileParser,
+                                      &found,
+                                      hist,
+                                      _unfilteredLineCount,
+                                      _unfilteredLineCount,
+                                      [&] { return found.size() || stopRequested(); },
+                                      {},
+                                      matchers);
+            searcher.search(lines);
+            if (found.size())
+                return found.get(0);
+            return {};
+        }
+
+        uint64_t done = 0;
+        for (auto index : lines) {
+            if (done++ % g_searchChunkSize == 0 && stopRequested())
+                return {};
+            fileParser->readLine(index, line);
+            if (matchers[0].match(line))
+                return index;
         }
+        return {};
     };
 
+    std::optional<uint64_t> startLine;
+    if (row) {
+        startLine = mapIndex(*row);
+    }
+
+    if (hasFilter()) {
+        auto it = _filter->begin();
+        auto end = _filter->end();
+        while (startLine && it != end && *it <= *startLine) {
+            ++it;
+        }
+        return findLines(IteratorRange{it, end});
+    }
+
+    auto first = startLine ? *startLine + 1 : 0;
+    return findLines(std::views::iota(first, _unfilteredLineCount));
+}
+
+bool Index::searchMany(FileParser* fileParser,
+                       const std::vector<SearchQuery>& queries,
+                       std::vector<QueryResult>& results,
+                       const std::vector<Hist*>& hists,
+                       std::function<bool()> stopRequested,
+                       std::function<void(uint64_t, uint64_t)> progress)
+{
+    assert(queries.size() == hists.size());
+    auto filtered = hasFilter();
+    auto lineCount = filtered ? _filter->numberOfOnes() : _unfilteredLineCount;
+
+    MultiQueryMatcher matcher(fileParser->lineParser(), queries);
+
+    log_infof("searching {} lines for {} queries, {} literal groups",
+              lineCount,
+              queries.size(),
+              matcher.literalGroupCount());
+
+    // only the line maps are built, the queries don't need copies of the index
+    results.clear();
+    for (auto i = 0u; i < queries.size(); ++i) {
+        results.push_back({std::make_shared<AppendOnlyLineMap>(1024), 0});
+    }
     std::shared_ptr<int> guard(nullptr, [&](auto) {
-        hist.freeze();
-        _lineMap = lineMap;
+        for (auto hist : hists) {
+            hist->freeze();
+        }
     });
 
-    if (_filtered) {
-        auto size = _filter.numberOfOnes();
+    auto searchLines = [&](const auto& lines) {
+        std::string line;
+        std::vector<char> matches(queries.size());
         uint64_t done = 0;
-        for (auto index : _filter) {
+        for (auto index : lines) {
             if (stopRequested())
                 return false;
-            add(index, done, size);
+            fileParser->readLine(index, line);
+            matcher.match(line, matches);
+            for (auto i = 0u; i < queries.size(); ++i) {
+                if (matches[i]) {
+                    results[i].lines->add(index);
+                    hists[i]->add(done, lineCount);
+                }
+            }
             done++;
             if (progress)
                 progress(index, _unfilteredLineCount);
         }
-    } else {
-        for (uint64_t i = 0; i < _unfilteredLineCount; ++i) {
-            if (stopRequested())
-                return false;
-            add(i, i, _unfilteredLineCount);
-            if (progress)
-                progress(i, _unfilteredLineCount);
+        return true;
+    };
+
+    auto complete = filtered ? searchLines(*_filter)
+                             : searchLines(std::views::iota(uint64_t{0}, _unfilteredLineCount));
+
+    auto limitHits = matcher.limitHits(queries.size());
+    for (auto i = 0u; i < queries.size(); ++i) {
+        results[i].regexLimitHits = limitHits[i];
+        if (limitHits[i]) {
+            log_infof("{} lines hit the regex match limit of query {} and were skipped",
+                      limitHits[i],
+                      i);
         }
-        _filtered = true;
     }
-    return true;
+    return complete;
+}
+
+// Every distinct value of an indexed column is matched once, the lines of the matching values
+// are the result.
+bool Index::searchColumn(FileParser* fileParser,
+                         int column,
+                         std::string text,
+                         bool regex,
+                         bool caseSensitive,
+                         bool unicodeAware,
+                         Hist& hist,
+                         std::function<bool()> stopRequested)
+{
+    assert((*_columns)[column].indexed);
+    auto searcher = createSearcher(text, regex, caseSensitive, unicodeAware);
+
+    std::vector<const ewah_bitset*> matching;
+    uint64_t limitHits = 0;
+    for (const auto& [value, lines] : (*_columns)[column].index) {
+        if (stopRequested())
+            return false;
+        auto previousLimitHits = searcher->limitHits();
+        if (std::get<0>(searcher->search(value, 0)) != -1) {
+            matching.push_back(&lines);
+        } else if (searcher->limitHits() != previousLimitHits) {
+            limitHits += lines.numberOfOnes();
+        }
+    }
+
+    log_infof("{} of {} values in column {} match",
+              matching.size(),
+              (*_columns)[column].index.size(),
+              column);
+
+    ewah_bitset lines;
+    if (!matching.empty()) {
+        lines = fast_logicalor(matching.size(), &matching[0]);
+    }
+
+    return searchCandidates(
+        fileParser, text, regex, caseSensitive, unicodeAware, false, false, hist,
+        [&](auto onLine) {
+            // counted after startSearch() has reset the count
+            _regexLimitHits = limitHits;
+            for (auto index : lines) {
+                onLine(index);
+            }
+            return true;
+        });
+}
+
+// shows the results of an earlier search without scanning the file again
+void Index::restoreSearchResults(const ewah_bitset& lines, uint64_t regexLimitHits) {
+    startSearch();
+    _regexLimitHits = regexLimitHits;
+    for (auto index : lines) {
+        _searchLineMap->add(index);
+    }
+}
+
+bool Index::searchCandidates(FileParser* fileParser,
+                             std::string text,
+                             bool regex,
+                             bool caseSensitive,
+                             bool unicodeAware,
+                             bool messageOnly,
+                             bool verify,
+                             Hist& hist,
+                             std::function<bool(std::function<void(uint64_t)>)> scan)
+{
+    auto filtered = hasFilter();
+    auto lineCount = filtered ? _filter->numberOfOnes() : _unfilteredLineCount;
+
+    LineMatcher matcher(fileParser->lineParser(), text, regex, caseSensitive, unicodeAware, messageOnly);
+
+    startSearch();
+    std::shared_ptr<int> guard(nullptr, [&](auto) {
+        finishSearch(hist, _regexLimitHits + matcher.limitHits());
+    });
+
+    std::string line;
+    ewah_bitset unfiltered;
+    auto& filter = filtered ? *_filter : unfiltered;
+    auto filterIt = filter.begin();
+    auto filterEnd = filter.end();
+    uint64_t filterRank = 0;
+
+    // candidates come in increasing order, the filter is walked alongside to find their ranks
+    auto result = scan([&](uint64_t index) {
+        if (filtered) {
+            while (filterIt != filterEnd && *filterIt < index) {
+                ++filterIt;
+                ++filterRank;
+            }
+            if (filterIt == filterEnd || *filterIt != index)
+                return;
+        }
+        if (verify || messageOnly) {
+            fileParser->readLine(index, line);
+            if (!matcher.match(line))
+                return;
+        }
+        _searchLineMap->add(index);
+        hist.add(filtered ? filterRank : index, lineCount);
+    });
+
+    return result;
+}
+
+ewah_bitset Index::searchResults() const {
+    assert(_searchLineMap);
+    return _searchLineMap->bitset();
+}
+
+uint64_t Index::regexLimitHits() const {
+    return _regexLimitHits;
 }
 
 uint64_t Index::getLineCount() {
@@ -492,67 +1391,126 @@ uint64_t Index::mapIndex(uint64_t index) {
     return _lineMap->get(index);
 }
 
+void Index::mapRange(uint64_t index, std::span<uint64_t> lineOffsets) {
+    if (!_filtered) {
+        std::iota(begin(lineOffsets), end(lineOffsets), index);
+        return;
+    }
+    _lineMap->getRange(index, lineOffsets);
+}
+
+std::optional<uint64_t> Index::findIndex(uint64_t lineOffset) {
+    if (!_filtered)
+        return lineOffset < _unfilteredLineCount ? std::optional(lineOffset) : std::nullopt;
+    return _lineMap->indexOf(lineOffset);
+}
+
 bool Index::index(FileParser* fileParser,
                   ILineParser* lineParser,
                   unsigned maxThreads,
                   std::function<bool()> stopRequested,
                   std::function<void(uint64_t, uint64_t)> progress)
 {
-    Indexer indexer(fileParser, lineParser, maxThreads, stopRequested, progress, &_columns);
+    std::shared_ptr<TrigramIndex> trigrams;
+    if (lineParser->trigramIndex() && fileParser->hasRawLines()) {
+        trigrams = std::make_shared<TrigramIndex>();
+    }
+    auto columns = std::make_shared<std::vector<ColumnInfo>>();
+    Indexer indexer(
+        fileParser, lineParser, maxThreads, stopRequested, progress, columns.get(), trigrams.get());
     auto res = indexer.index();
+    auto formats = lineParser->getColumnFormats();
+    for (auto i = 0u; i < columns->size() && i < formats.size(); ++i) {
+        auto& column = (*columns)[i];
+        column.order = formats[i].order;
+        column.orderedValues.clear();
+        for (auto& [value, _] : column.index) {
+            column.orderedValues.push_back(value);
+        }
+        std::ranges::sort(column.orderedValues, [&](auto& left, auto& right) {
+            return column.order.less(left, right);
+        });
+    }
+    _columns = std::move(columns);
+    _selections.assign(_columns->size(), nullptr);
+    _values.clear();
+    _trigrams = res ? trigrams : nullptr;
     _unfilteredLineCount = fileParser->lineCount();
     return res;
 }
 
-std::vector<ColumnIndexInfo> Index::getValues(int column) {
-    Stopwatch sw;
+std::vector<ColumnIndexInfo> Index::getValues(int column, unsigned maxThreads) {
+    assert(_columns->at(column).indexed);
+    if (auto it = _values.find(column); it != end(_values))
+        return *it->second;
 
-    assert(_columns.at(column).indexed);
-    std::vector<ColumnIndexInfo> values;
-    for (auto& [value, index] : _columns[column].index) {
-        auto checked = true;
-        auto filter = std::find_if(begin(_filters), end(_filters), [&] (auto& filter) {
-            return filter.column == column;
-        });
-        if (filter != end(_filters)) {
-            auto& selected = filter->selected;
-            checked = selected.find(value) != end(selected);
-        }
+    Stopwatch sw;
 
-        auto first = begin(_filters);
-        auto last = end(_filters);
-        if (filter != end(_filters)) {
-            std::swap(*filter, end(_filters)[-1]);
-            --last;
-        }
+    auto filter = std::ranges::find(_filters, column, &ColumnFilter::column);
 
-        size_t count = 0;
-        if (first == last) {
-            count = index.numberOfOnes();
-        } else {
-            auto otherColumnsIndex = _columns[first->column].currentIndex;
-            for (auto it = first + 1; it != last; ++it) {
-                otherColumnsIndex = otherColumnsIndex & _columns[it->column].currentIndex;
-            }
-            count = (otherColumnsIndex & index).numberOfOnes();
-        }
-        values.push_back({value, checked, count});
+    // a value is counted among the lines the filters of the other columns leave, an expression
+    // can't be split by column and all the lines it leaves are counted
+    std::optional<ewah_bitset> otherColumnsIndex;
+    if (_expression) {
+        otherColumnsIndex = *_filter;
+    }
+    for (auto& other : _filters) {
+        if (other.column == column)
+            continue;
+        auto currentIndex = filterLines(other, maxThreads);
+        otherColumnsIndex = otherColumnsIndex ? *otherColumnsIndex & currentIndex
+                                              : std::move(currentIndex);
     }
 
+    std::vector<ColumnIndexInfo> values;
+    std::vector<const ewah_bitset*> valueIndexes;
+    auto& columnInfo = (*_columns)[column];
+    values.reserve(columnInfo.index.size());
+    valueIndexes.reserve(columnInfo.index.size());
+    for (auto& value : columnInfo.orderedValues) {
+        auto checked =
+            filter == end(_filters) || filter->selected.contains(value) != filter->exclude;
+        values.push_back({value, checked, 0});
+        valueIndexes.push_back(&columnInfo.index.at(value));
+    }
 
-    std::ranges::sort(values, {}, &ColumnIndexInfo::value);
+    parallelForIndex(values.size(), workerCount(maxThreads), g_valueCountChunkSize, [&](size_t i) {
+        values[i].count = otherColumnsIndex ? otherColumnsIndex->logicalandcount(*valueIndexes[i])
+                                            : valueIndexes[i]->numberOfOnes();
+    });
 
     log_infof("Index::getValues({}) finished in {}", column, sw.msElapsed());
 
+    _values[column] = std::make_shared<const std::vector<ColumnIndexInfo>>(values);
     return values;
 }
 
+std::vector<std::string> Index::getValueNames(int column) const {
+    return _columns->at(column).orderedValues;
+}
+
+std::set<std::string> Index::valuesInRange(int column,
+                                           const std::optional<std::string>& low,
+                                           const std::optional<std::string>& high) const {
+    auto& info = _columns->at(column);
+    assert(info.indexed);
+    auto less = [&](const std::string& left, const std::string& right) {
+        return info.order.less(left, right);
+    };
+    auto& values = info.orderedValues;
+    auto first = low ? std::lower_bound(begin(values), end(values), *low, less) : begin(values);
+    auto last = high ? std::upper_bound(begin(values), end(values), *high, less) : end(values);
+    if (first >= last)
+        return {};
+    return {first, last};
+}
+
 size_t Index::numberOfValues(int column) const {
-    return _columns.at(column).index.size();
+    return _columns->at(column).index.size();
 }
 
 ColumnWidth Index::maxWidth(int column) {
-    return _columns.at(column).maxWidth;
+    return _columns->at(column).maxWidth;
 }
 
 } // namespace seer
@@ -3,9 +3,10 @@
 #include "FileParser.h"
 #include "ILineParser.h"
 #include "RandomBitArray.h"
-#include "IndexedEwah.h"
+#include "RankSelect.h"
 #include "Hist.h"
 #include "FilterAlgo.h"
+#include "FilterExpr.h"
 #include <stdint.h>
 #include <string>
 #include <unordered_map>
@@ -14,11 +15,18 @@
 #include <tuple>
 #include <set>
 #include <memory>
+#include <optional>
 
 namespace seer {
 
+class TrigramIndex;
+class AppendOnlyLineMap;
+
 inline constexpr int g_tabWidth = 4;
 
+// an estimate of the memory the set and its strings take
+size_t valuesSizeInBytes(const std::set<std::string>& values);
+
 struct ColumnIndexInfo {
     std::string value;
     bool checked;
@@ -27,9 +35,29 @@ struct ColumnIndexInfo {
     bool operator==(const ColumnIndexInfo&) const = default;
 };
 
+// the lines having one of the selected values of a column, or none of them when excluding, which
+// keeps a filter dropping a few values as small as those values
 struct ColumnFilter {
     int column;
     std::set<std::string> selected;
+    bool exclude = false;
+
+    bool operator==(const ColumnFilter&) const = default;
+    size_t sizeInBytes() const;
+};
+
+struct SearchQuery {
+    std::string text;
+    bool regex = false;
+    bool caseSensitive = false;
+    bool unicodeAware = false;
+    bool messageOnly = false;
+};
+
+// the lines one query of searchMany found
+struct QueryResult {
+    std::shared_ptr<AppendOnlyLineMap> lines;
+    uint64_t regexLimitHits = 0;
 };
 
 struct ColumnWidth {
@@ -41,27 +69,89 @@ struct ColumnWidth {
     }
 };
 
+// the lines having one of the selected values of a column
+struct ColumnSelection {
+    ewah_bitset lines;
+    std::set<std::string> values;
+};
+
+// what indexing learns about a column, it is immutable afterwards and every copy of the index
+// shares it
 struct ColumnInfo {
     std::unordered_map<std::string, ewah_bitset> index;
     bool indexed = false;
     ColumnWidth maxWidth;
-    ewah_bitset currentIndex;
-    std::set<std::string> selectedValues;
+    ValueOrder order;
+    // the values of the index sorted by the order of the column
+    std::vector<std::string> orderedValues;
+};
+
+// the state a filter leaves in the index, it can be restored without filtering again
+struct FilterSnapshot {
+    std::vector<ColumnFilter> filters;
+    std::optional<FilterExpr> expression;
+    std::shared_ptr<const ewah_bitset> filter;
+    std::shared_ptr<IRandomArray> lineMap;
+    std::vector<std::shared_ptr<const ColumnSelection>> selections;
+    std::unordered_map<int, std::shared_ptr<const std::vector<ColumnIndexInfo>>> values;
+
+    // the bitmaps and also the value names and counts, which are as large for columns with many
+    // values
+    size_t sizeInBytes() const;
 };
 
 class Index {
     std::shared_ptr<IRandomArray> _lineMap;
-    std::vector<ColumnInfo> _columns;
+    // copying the index copies only what a view filters and searches, never the columns
+    std::shared_ptr<const std::vector<ColumnInfo>> _columns =
+        std::make_shared<const std::vector<ColumnInfo>>();
+    std::vector<std::shared_ptr<const ColumnSelection>> _selections;
     uint64_t _unfilteredLineCount = 0;
     bool _filtered = false;
-    ewah_bitset _filter;
+    std::shared_ptr<const ewah_bitset> _filter;
     std::vector<ColumnFilter> _filters;
-    void makePerColumnIndex(std::vector<ColumnFilter>::const_iterator first,
-                            std::vector<ColumnFilter>::const_iterator last);
+    std::optional<FilterExpr> _expression;
+    std::shared_ptr<const TrigramIndex> _trigrams;
+    std::shared_ptr<AppendOnlyLineMap> _searchLineMap;
+    uint64_t _regexLimitHits = 0;
+    // getValues results per column, valid until the filter changes
+    std::unordered_map<int, std::shared_ptr<const std::vector<ColumnIndexInfo>>> _values;
+    // the lines having one of the selected values, kept per column so that changing the selection
+    // can start from the previous one
+    const ewah_bitset& columnIndex(int column,
+                                   const std::set<std::string>& selected,
+                                   unsigned maxThreads);
+    uint64_t countValues(int column, const std::set<std::string>& values) const;
+    ewah_bitset filterLines(const ColumnFilter& filter, unsigned maxThreads);
+    bool applyFilter(const FilterExpr& expression,
+                     std::function<bool()> stopRequested,
+                     unsigned maxThreads);
+    bool hasFilter() const;
+    void startSearch();
+    void finishSearch(Hist& hist, uint64_t regexLimitHits);
+    bool searchCandidates(FileParser* fileParser,
+                          std::string text,
+                          bool regex,
+                          bool caseSensitive,
+                          bool unicodeAware,
+                          bool messageOnly,
+                          bool verify,
+                          Hist& hist,
+                          std::function<bool(std::function<void(uint64_t)>)> scan);
 
 public:
     Index(uint64_t unfilteredLineCount = 0);
-    void filter(const std::vector<ColumnFilter>& filters);
+    // returns false when stopped, the index is then only partially filtered and must be discarded;
+    // large value sets are OR-ed on up to maxThreads threads, 0 uses every core
+    bool filter(const std::vector<ColumnFilter>& filters,
+                std::function<bool()> stopRequested = [] { return false; },
+                unsigned maxThreads = 0);
+    bool filterExpression(const FilterExpr& expression,
+                          std::function<bool()> stopRequested = [] { return false; },
+                          unsigned maxThreads = 0);
+    // shares the filtered lines with the snapshot, taking or restoring one doesn't copy them
+    std::shared_ptr<const FilterSnapshot> filterSnapshot() const;
+    void restoreFilter(const FilterSnapshot& snapshot);
     bool search(FileParser* fileParser,
                 std::string text,
                 bool regex,
@@ -70,15 +160,61 @@ public:
                 bool messageOnly,
                 Hist& hist,
                 std::function<bool()> stopRequested = [] { return false; },
-                std::function<void(uint64_t, uint64_t)> progress = {});
+                std::function<void(uint64_t, uint64_t)> progress = {},
+                unsigned maxThreads = 0,
+                const ewah_bitset* scope = nullptr);
+    // finds the first line after the row, or before it when going backward, without searching
+    // the whole file; with no row the search starts at the first or the last line
+    std::optional<uint64_t> find(FileParser* fileParser,
+                                 std::optional<uint64_t> row,
+                                 bool backward,
+                                 std::string text,
+                                 bool regex,
+                                 bool caseSensitive,
+                                 bool unicodeAware,
+                                 bool messageOnly,
+                                 std::function<bool()> stopRequested = [] { return false; },
+                                 unsigned maxThreads = 0);
+    // runs all queries in one pass over the lines, results[i] and hists[i] receive the matches of
+    // queries[i]; restoreSearchResults shows one of them
+    bool searchMany(FileParser* fileParser,
+                    const std::vector<SearchQuery>& queries,
+                    std::vector<QueryResult>& results,
+                    const std::vector<Hist*>& hists,
+                    std::function<bool()> stopRequested = [] { return false; },
+                    std::function<void(uint64_t, uint64_t)> progress = {});
+    bool searchColumn(FileParser* fileParser,
+                      int column,
+                      std::string text,
+                      bool regex,
+                      bool caseSensitive,
+                      bool unicodeAware,
+                      Hist& hist,
+                      std::function<bool()> stopRequested = [] { return false; });
+    ewah_bitset searchResults() const;
+    void restoreSearchResults(const ewah_bitset& lines, uint64_t regexLimitHits = 0);
+    // the number of lines the last search skipped because the regex hit its match limit
+    uint64_t regexLimitHits() const;
     uint64_t getLineCount();
     uint64_t mapIndex(uint64_t index);
+    // the inverse of mapIndex, nothing if the line is filtered out
+    std::optional<uint64_t> findIndex(uint64_t lineOffset);
+    // mapIndex of the consecutive indexes starting at index
+    void mapRange(uint64_t index, std::span<uint64_t> lineOffsets);
     bool index(FileParser* fileParser,
                ILineParser* lineParser,
                unsigned maxThreads,
                std::function<bool()> stopRequested,
                std::function<void(uint64_t, uint64_t)> progress = {});
-    std::vector<ColumnIndexInfo> getValues(int column);
+    // counts the values on up to maxThreads threads, 0 uses every core
+    std::vector<ColumnIndexInfo> getValues(int column, unsigned maxThreads = 0);
+    // the values of a column in its order without counting them
+    std::vector<std::string> getValueNames(int column) const;
+    // the values between the bounds in the order of the column, both bounds are inclusive and
+    // don't have to be values of the column themselves
+    std::set<std::string> valuesInRange(int column,
+                                        const std::optional<std::string>& low,
+                                        const std::optional<std::string>& high) const;
     size_t numberOfValues(int column) const;
     ColumnWidth maxWidth(int column);
 };
@@ -1,5 +1,5 @@
 #include "IndexedEwah.h"
-#include <bitset>
+#include "RankSelect.h"
 #include <bit>
 
 namespace seer {
@@ -29,44 +29,41 @@ void IndexedEwah::init(const ewah::EWAHBoolArray<uint64_t> &ewah) {
     // last bucket may contain one extra word
 }
 
-size_t indexOfNthSetBit(uint64_t word, size_t n) {
-    assert(static_cast<size_t>(std::popcount(word)) > n);
-    size_t index = 0;
-    std::bitset<64> bits(word);
-    for (;;) {
-        while (!bits[index])
-            index++;
-        if (n == 0)
-            return index;
-        n--;
-        index++;
-    }
-    return index;
+uint64_t IndexedEwah::get(uint64_t index) {
+    uint64_t value;
+    getRange(index, {&value, 1});
+    return value;
 }
 
-uint64_t IndexedEwah::get(uint64_t index) {
-    assert(index < _size);
+void IndexedEwah::getRange(uint64_t index, std::span<uint64_t> values) {
+    if (values.empty())
+        return;
+    assert(index + values.size() <= _size);
     auto it = std::lower_bound(
         begin(_buckets), end(_buckets), index, [](const Bucket& a, uint64_t index) {
             return a.firstIndex < index;
         });
     if (it == end(_buckets) || it->firstIndex != index)
         --it;
-    uint64_t value = std::distance(begin(_buckets), it) * _bucketSize;
+    uint64_t position = std::distance(begin(_buckets), it) * _bucketSize;
     auto ewahIt = it->iter;
     index -= it->firstIndex;
-    for (;;) {
+    size_t filled = 0;
+    for (; filled < values.size(); position += g_bitsInWord) {
         assert(ewahIt.hasNext());
         auto word = ewahIt.next();
         size_t ones = std::popcount(word);
-        if (ones > index) {
-            return value + indexOfNthSetBit(word, index);
+        if (ones <= index) {
+            index -= ones;
+            continue;
+        }
+        // skip the set bits before the first requested one
+        word &= ~uint64_t{0} << selectInWord(word, index);
+        index = 0;
+        for (; word && filled < values.size(); word &= word - 1) {
+            values[filled++] = position + std::countr_zero(word);
         }
-        index -= ones;
-        value += g_bitsInWord;
     }
-    assert(false);
-    return 0;
 }
 
 uint64_t IndexedEwah::size() const {
@@ -22,6 +22,7 @@ public:
     IndexedEwah(unsigned bucketSize);
     void init(ewah::EWAHBoolArray<uint64_t> const& ewah);
     uint64_t get(uint64_t index) override;
+    void getRange(uint64_t index, std::span<uint64_t> values) override;
     uint64_t size() const override;
     size_t sizeInBytes() const;
 };
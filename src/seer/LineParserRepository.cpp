@@ -3,9 +3,13 @@
 #include "FileParser.h"
 
 #include "Log.h"
+#include "ParallelFor.h"
+#include "Stopwatch.h"
+#include <fmt/chrono.h>
 #include <filesystem>
 #include <regex>
 #include <limits>
+#include <numeric>
 
 using namespace std::filesystem;
 
@@ -69,13 +73,27 @@ std::shared_ptr<ILineParser> LineParserRepository::resolve(std::istream& stream)
         sample.push_back(line);
     }
 
+    std::vector<std::shared_ptr<ILineParser>> candidates;
     for (auto& [_, parser] : _parsers) {
-        log_infof("trying parser [{}]", parser->name());
-        if (parser->isMatch(sample, "") || parser == (--end(_parsers))->second) {
+        candidates.push_back(parser);
+    }
+
+    std::vector<size_t> indices(candidates.size());
+    std::iota(begin(indices), end(indices), 0);
+    std::vector<char> matches(candidates.size());
+    Stopwatch sw;
+    parallelFor(indices, [&](size_t i) {
+        log_infof("trying parser [{}]", candidates[i]->name());
+        matches[i] = candidates[i]->isMatch(sample, "");
+    });
+    log_infof("detectors evaluated in {}", sw.msElapsed());
+
+    for (auto i = 0u; i < candidates.size(); ++i) {
+        if (matches[i] || i == candidates.size() - 1) {
             stream.clear();
             stream.seekg(0);
-            log_infof("selected parser [{}]", parser->name());
-            return parser;
+            log_infof("selected parser [{}]", candidates[i]->name());
+            return candidates[i];
         }
     }
     return nullptr;
@@ -0,0 +1,87 @@
+#include "MultiLiteralSearcher.h"
+
+#include <assert.h>
+#include <queue>
+
+namespace seer {
+
+namespace {
+
+unsigned char fold(unsigned char c) {
+    return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+} // namespace
+
+MultiLiteralSearcher::MultiLiteralSearcher(const std::vector<std::string>& patterns,
+                                           bool caseSensitive)
+    : _patternCount(patterns.size()), _caseSensitive(caseSensitive) {
+    State root;
+    root.next.fill(-1);
+    _states.push_back(root);
+
+    for (auto i = 0u; i < patterns.size(); ++i) {
+        assert(!patterns[i].empty());
+        int state = 0;
+        for (unsigned char c : patterns[i]) {
+            if (!caseSensitive) {
+                c = fold(c);
+            }
+            if (_states[state].next[c] == -1) {
+                State newState;
+                newState.next.fill(-1);
+                _states[state].next[c] = _states.size();
+                _states.push_back(std::move(newState));
+            }
+            state = _states[state].next[c];
+        }
+        _states[state].patterns.push_back(i);
+    }
+
+    // turn the trie into a DFA, breadth first so that the failure state of every state is
+    // complete before the state itself
+    std::vector<int32_t> failure(_states.size(), 0);
+    std::queue<int32_t> queue;
+    for (auto& next : _states[0].next) {
+        if (next == -1) {
+            next = 0;
+        } else {
+            queue.push(next);
+        }
+    }
+
+    while (!queue.empty()) {
+        auto state = queue.front();
+        queue.pop();
+        auto& failurePatterns = _states[failure[state]].patterns;
+        _states[state].patterns.insert(
+            end(_states[state].patterns), begin(failurePatterns), end(failurePatterns));
+        for (auto c = 0; c < 256; ++c) {
+            auto& next = _states[state].next[c];
+            auto failureNext = _states[failure[state]].next[c];
+            if (next == -1) {
+                next = failureNext;
+            } else {
+                failure[next] = failureNext;
+                queue.push(next);
+            }
+        }
+    }
+}
+
+void MultiLiteralSearcher::search(std::string_view text, std::vector<char>& found) const {
+    found.assign(_patternCount, false);
+    int32_t state = 0;
+    for (unsigned char c : text) {
+        state = _states[state].next[_caseSensitive ? c : fold(c)];
+        for (auto pattern : _states[state].patterns) {
+            found[pattern] = true;
+        }
+    }
+}
+
+int MultiLiteralSearcher::patternCount() const {
+    return _patternCount;
+}
+
+} // namespace seer
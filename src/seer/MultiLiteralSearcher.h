@@ -0,0 +1,30 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdint.h>
+
+namespace seer {
+
+// Finds which of several literal patterns occur in a text in a single pass (Aho-Corasick). When
+// not case sensitive, ASCII letters are folded the same way a caseless non-unicode regex does.
+class MultiLiteralSearcher {
+    struct State {
+        std::array<int32_t, 256> next;
+        std::vector<int> patterns;
+    };
+
+    std::vector<State> _states;
+    int _patternCount;
+    bool _caseSensitive;
+
+public:
+    MultiLiteralSearcher(const std::vector<std::string>& patterns, bool caseSensitive);
+    // sets found[i] for every pattern i that occurs in the text
+    void search(std::string_view text, std::vector<char>& found) const;
+    int patternCount() const;
+};
+
+} // namespace seer
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <blockingconcurrentqueue.h>
+#include <algorithm>
+#include <atomic>
 #include <thread>
 #include <optional>
 #include <vector>
@@ -41,4 +43,32 @@ void parallelFor(const C& container, F action) {
     }
 }
 
+// calls action(i) for every i in [0, count), the threads take the indices in chunks as they go
+template <typename F>
+void parallelForIndex(size_t count, unsigned threadCount, size_t chunkSize, F action) {
+    std::atomic<size_t> next = 0;
+    auto body = [&] {
+        for (;;) {
+            auto first = next.fetch_add(chunkSize);
+            if (first >= count)
+                return;
+            auto last = std::min(first + chunkSize, count);
+            for (auto i = first; i < last; ++i) {
+                action(i);
+            }
+        }
+    };
+
+    threadCount = std::min<size_t>(threadCount, (count + chunkSize - 1) / chunkSize);
+    std::vector<std::thread> threads;
+    for (auto i = 1u; i < threadCount; ++i) {
+        threads.emplace_back(body);
+    }
+    body();
+
+    for (auto& th : threads) {
+        th.join();
+    }
+}
+
 } // namespace seer
@@ -24,12 +24,43 @@ uint64_t RandomBitArray::get(uint64_t index) {
     return *it;
 }
 
+void RandomBitArray::getRange(uint64_t index, std::span<uint64_t> values) {
+    if (values.empty())
+        return;
+    assert(index + values.size() <= size());
+    auto bucket = index / _bucketSize;
+    auto position = index % _bucketSize;
+    auto it = _buckets[bucket].begin();
+    for (auto i = 0u; i < position; ++i) {
+        ++it;
+    }
+    for (auto& value : values) {
+        if (position == _bucketSize) {
+            it = _buckets[++bucket].begin();
+            position = 0;
+        }
+        value = *it;
+        ++it;
+        ++position;
+    }
+}
+
 uint64_t RandomBitArray::size() const {
     if (_buckets.empty())
         return 0;
     return (_buckets.size() - 1) * _bucketSize + _currentBucketSize;
 }
 
+ewah::EWAHBoolArray<uint64_t> RandomBitArray::bitset() const {
+    std::vector<const ewah::EWAHBoolArray<uint64_t>*> buckets;
+    for (auto& bucket : _buckets) {
+        buckets.push_back(&bucket);
+    }
+    if (buckets.empty())
+        return {};
+    return ewah::fast_logicalor(buckets.size(), &buckets[0]);
+}
+
 void RandomBitArray::clear() {
     _lastValue = 0;
     _buckets.clear();
@@ -16,8 +16,10 @@ public:
     RandomBitArray(unsigned bucketSize);
     void add(uint64_t value);
     uint64_t get(uint64_t index) override;
+    void getRange(uint64_t index, std::span<uint64_t> values) override;
     uint64_t size() const override;
     void clear();
+    ewah::EWAHBoolArray<uint64_t> bitset() const;
 };
 
 } // namespace seer
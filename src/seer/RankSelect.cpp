@@ -0,0 +1,126 @@
+#include "RankSelect.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <bit>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#define SEER_SELECT_BMI2
+#endif
+
+namespace seer {
+
+namespace {
+
+constexpr uint64_t g_bitsInWord = 64;
+constexpr uint64_t g_wordsInBlock = 8;
+constexpr uint64_t g_bitsInBlock = g_bitsInWord * g_wordsInBlock;
+constexpr uint64_t g_selectSample = 1024;
+
+} // namespace
+
+unsigned selectInWord(uint64_t word, unsigned n) {
+    assert(static_cast<unsigned>(std::popcount(word)) > n);
+#ifdef SEER_SELECT_BMI2
+    // deposit a single bit into the n-th set bit of the word, countr_zero compiles to tzcnt
+    return std::countr_zero(_pdep_u64(uint64_t{1} << n, word));
+#else
+    for (auto i = 0u; i < n; ++i) {
+        word &= word - 1;
+    }
+    return std::countr_zero(word);
+#endif
+}
+
+void RankSelect::init(const ewah::EWAHBoolArray<uint64_t>& ewah) {
+    _words.clear();
+    _words.reserve((ewah.sizeInBits() + g_bitsInWord - 1) / g_bitsInWord);
+    auto it = ewah.uncompress();
+    while (it.hasNext()) {
+        _words.push_back(it.next());
+    }
+    // pad to whole blocks so that rank never reads past the end
+    _words.resize((_words.size() + g_wordsInBlock - 1) / g_wordsInBlock * g_wordsInBlock);
+
+    auto blockCount = _words.size() / g_wordsInBlock;
+    _blockRanks.clear();
+    _blockRanks.reserve(blockCount + 1);
+    _selectSamples.clear();
+    uint64_t ones = 0;
+    for (auto block = 0u; block < blockCount; ++block) {
+        _blockRanks.push_back(ones);
+        for (auto i = 0u; i < g_wordsInBlock; ++i) {
+            ones += std::popcount(_words[block * g_wordsInBlock + i]);
+        }
+        while (_selectSamples.size() * g_selectSample < ones) {
+            _selectSamples.push_back(block);
+        }
+    }
+    _blockRanks.push_back(ones);
+}
+
+uint64_t RankSelect::get(uint64_t index) {
+    assert(index < size());
+    auto sample = index / g_selectSample;
+    auto first = begin(_blockRanks) + _selectSamples[sample];
+    auto last = sample + 1 < _selectSamples.size()
+                    ? begin(_blockRanks) + _selectSamples[sample + 1] + 1
+                    : end(_blockRanks) - 1;
+    auto block = std::distance(begin(_blockRanks), std::upper_bound(first, last, index)) - 1;
+    index -= _blockRanks[block];
+    for (auto word = block * g_wordsInBlock;; ++word) {
+        uint64_t ones = std::popcount(_words[word]);
+        if (ones > index) {
+            return word * g_bitsInWord + selectInWord(_words[word], index);
+        }
+        index -= ones;
+    }
+}
+
+void RankSelect::getRange(uint64_t index, std::span<uint64_t> values) {
+    if (values.empty())
+        return;
+    assert(index + values.size() <= size());
+    auto first = get(index);
+    auto word = first / g_bitsInWord;
+    auto bits = _words[word] & (~uint64_t{0} << (first % g_bitsInWord));
+    for (auto& value : values) {
+        while (!bits) {
+            bits = _words[++word];
+        }
+        value = word * g_bitsInWord + std::countr_zero(bits);
+        bits &= bits - 1;
+    }
+}
+
+uint64_t RankSelect::size() const {
+    return _blockRanks.empty() ? 0 : _blockRanks.back();
+}
+
+std::optional<uint64_t> RankSelect::indexOf(uint64_t value) {
+    auto word = value / g_bitsInWord;
+    if (word >= _words.size() || !(_words[word] & (uint64_t{1} << (value % g_bitsInWord))))
+        return {};
+    return rank(value);
+}
+
+uint64_t RankSelect::rank(uint64_t position) const {
+    auto word = position / g_bitsInWord;
+    if (word >= _words.size())
+        return size();
+    auto block = position / g_bitsInBlock;
+    auto ones = _blockRanks[block];
+    for (auto i = block * g_wordsInBlock; i < word; ++i) {
+        ones += std::popcount(_words[i]);
+    }
+    auto below = (uint64_t{1} << (position % g_bitsInWord)) - 1;
+    return ones + std::popcount(_words[word] & below);
+}
+
+size_t RankSelect::sizeInBytes() const {
+    return _words.size() * sizeof(uint64_t) + _blockRanks.size() * sizeof(uint64_t) +
+           _selectSamples.size() * sizeof(uint32_t);
+}
+
+} // namespace seer
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "IRandomArray.h"
+#include <ewah/ewah.h>
+#include <vector>
+
+namespace seer {
+
+// the position of the n-th (counting from 0) set bit of the word, which must have more than n
+unsigned selectInWord(uint64_t word, unsigned n);
+
+// The set bits of a bitmap with constant time rank and near constant time select. The bitmap is
+// kept uncompressed together with the number of set bits before every block of words, and the
+// block holding every g_selectSample-th set bit is sampled so that select only has to search the
+// few blocks between two samples.
+class RankSelect : public IRandomArray {
+    std::vector<uint64_t> _words;
+    // the number of set bits before each block, the last entry is the total
+    std::vector<uint64_t> _blockRanks;
+    std::vector<uint32_t> _selectSamples;
+
+public:
+    void init(ewah::EWAHBoolArray<uint64_t> const& ewah);
+    // select: the position of the index-th set bit
+    uint64_t get(uint64_t index) override;
+    void getRange(uint64_t index, std::span<uint64_t> values) override;
+    uint64_t size() const override;
+    std::optional<uint64_t> indexOf(uint64_t value) override;
+    // the number of set bits before the position
+    uint64_t rank(uint64_t position) const;
+    size_t sizeInBytes() const;
+};
+
+} // namespace seer
@@ -6,6 +6,7 @@
 #include <boost/algorithm/string.hpp>
 #include <fmt/format.h>
 #include <sstream>
+#include <mutex>
 
 #define PCRE2_CODE_UNIT_WIDTH 8
 #include <pcre2.h>
@@ -14,11 +15,60 @@ using namespace nlohmann;
 
 namespace seer {
 
+constexpr std::chrono::milliseconds g_defaultDetectorTimeout{500};
+constexpr int g_derivedColumnInstructions = 1'000'000;
+
 class RegexLineParserContext : public ILineParserContext {
 public:
     std::shared_ptr<pcre2_match_data> matchData;
+    std::unique_ptr<LuaThread> lua;
+    int derivedScript = 0;
+    std::vector<std::string> derivedValues;
+    std::vector<std::vector<std::string>*> rows;
 };
 
+// a branch reset group numbers the groups of each alternative from the same starting point,
+// so every alternative maps onto the same columns and the whole set is matched in one go
+std::string combineAlternatives(const std::vector<std::string>& alternatives) {
+    if (alternatives.size() == 1)
+        return alternatives.front();
+    std::string pattern = "(?|";
+    for (auto i = 0u; i < alternatives.size(); ++i) {
+        if (i) {
+            pattern += "|";
+        }
+        pattern += "(?:" + alternatives[i] + ")";
+    }
+    pattern += ")";
+    return pattern;
+}
+
+std::string makeDerivedColumnsScript(const std::vector<std::string>& scripts) {
+    std::string text = "local rows = ...\nlocal derived = {}\n";
+    for (auto i = 0u; i < scripts.size(); ++i) {
+        text += fmt::format("derived[{}] = function(columns)\n{}\nend\n", i + 1, scripts[i]);
+    }
+    // every cell runs in its own protected call under an instruction budget, an error or an
+    // endless loop empties that cell only, whichever rows share its batch
+    text += fmt::format("local budget = {}\n", g_derivedColumnInstructions);
+    text += "local sethook, pcall, tostring, error = debug.sethook, pcall, tostring, error\n"
+            "local function exhausted() error('instruction budget exceeded') end\n"
+            "local function cell(script, row) return tostring(script(row) or '') end\n"
+            "local result = {}\n"
+            "local n = 0\n"
+            "for i = 1, #rows do\n"
+            "    for j = 1, #derived do\n"
+            "        n = n + 1\n"
+            "        sethook(exhausted, '', budget)\n"
+            "        local ok, value = pcall(cell, derived[j], rows[i])\n"
+            "        sethook()\n"
+            "        result[n] = ok and value or ''\n"
+            "    end\n"
+            "end\n"
+            "return result\n";
+    return text;
+}
+
 class MagicLogDetector : public ILogDetector {
     std::string _magic;
 public:
@@ -47,33 +97,37 @@ public:
 
 class LuaLogDetector : public ILogDetector {
     RegexLineParser* _parser;
-    std::string _script;
+    LuaThread _thread;
+    int _script;
+    std::mutex _mutex;
+
 public:
-    LuaLogDetector(RegexLineParser* parser, std::string script) : _parser(parser), _script(script) {
-        LuaThread thread;
-        if (!thread.pushScript(script))
+    LuaLogDetector(RegexLineParser* parser, std::string script, std::chrono::milliseconds timeout)
+        : _parser(parser) {
+        auto ref = _thread.loadScript(script);
+        if (!ref)
             throw std::runtime_error("lua script syntax error");
+        _script = *ref;
+        _thread.setTimeout(timeout);
     }
 
     bool isMatch(const std::vector<std::string>& lines, std::string_view fileName) override {
-        LuaThread thread;
-        LuaTable luaLines;
+        std::vector<bool> parsed(lines.size());
         std::vector<std::string> columns;
+        auto context = _parser->createContext();
         for (auto i = 0u; i < lines.size(); ++i) {
-            auto luaLine = std::make_shared<LuaTable>();
-            luaLine->insert(std::make_shared<LuaString>("text"),
-                            std::make_shared<LuaString>(lines[i]));
-            luaLine->insert(std::make_shared<LuaString>("parsed"),
-                            std::make_shared<LuaBool>(_parser->parseLine(lines[i], columns, *_parser->createContext())));
-            luaLines.insert(std::make_shared<LuaInt>(i), luaLine);
+            parsed[i] = _parser->parseLine(lines[i], columns, *context);
         }
-        thread.setGlobal("lines", luaLines);
+
+        auto lock = std::lock_guard(_mutex);
+        LuaLineArray luaLines(lines, parsed);
+        _thread.setGlobal("lines", luaLines);
         LuaString luaFileName{std::string(fileName)};
-        thread.setGlobal("fileName", luaFileName);
-        thread.pushScript(_script);
-        if (!thread.execTop())
+        _thread.setGlobal("fileName", luaFileName);
+        _thread.pushScript(_script);
+        if (!_thread.execTop())
             return false;
-        return thread.popBool();
+        return _thread.popBool();
     }
 };
 
@@ -85,6 +139,18 @@ std::string reErrorToString(int code) {
     return error;
 }
 
+ValueOrder parseValueOrder(const json& order) {
+    if (order.is_null() || order == "lexicographic")
+        return {};
+    if (order == "numeric")
+        return {ValueOrder::Kind::Numeric, {}};
+    if (order.is_array())
+        return {ValueOrder::Kind::Explicit, order.get<std::vector<std::string>>()};
+    throw OptionInconsistencyException(
+        fmt::format("column order must be 'lexicographic', 'numeric' or an array of values, got {}",
+                    order.dump()));
+}
+
 void RegexLineParser::load(std::string config) {
     std::string rePattern;
 
@@ -93,9 +159,19 @@ void RegexLineParser::load(std::string config) {
         json j;
         ss >> j;
         auto description = j["description"].get<std::string>();
-        rePattern = j["regex"].get<std::string>();
+        auto regex = j["regex"];
+        if (regex.is_array()) {
+            std::vector<std::string> alternatives;
+            for (auto it = begin(regex); it != end(regex); ++it) {
+                alternatives.push_back(it->get<std::string>());
+            }
+            rePattern = combineAlternatives(alternatives);
+        } else {
+            rePattern = regex.get<std::string>();
+        }
 
         auto& columns = j["columns"];
+        _trigramIndex = j.value("trigramIndex", false);
         auto magic = j["magic"];
         auto detector = j["detector"];
 
@@ -110,17 +186,42 @@ void RegexLineParser::load(std::string config) {
                 text += it->get<std::string>();
                 text += "\n";
             }
-            _detector = std::make_shared<LuaLogDetector>(this, text);
+            auto timeout = std::chrono::milliseconds(
+                j.value("detectorTimeout", g_defaultDetectorTimeout.count()));
+            _detector = std::make_shared<LuaLogDetector>(this, text, timeout);
         } else {
             _detector = std::make_shared<DefaultLogDetector>(this);
         }
 
+        std::vector<std::string> derivedScripts;
         for (auto it = begin(columns); it != end(columns); ++it) {
             auto name = (*it)["name"].get<std::string>();
-            auto group = (*it)["group"].get<int>();
             auto indexed = it->value("indexed", false);
             auto autosize = it->value("autosize", false);
-            _formats.push_back({name, group, indexed, autosize});
+            auto order = parseValueOrder(it->value("order", json()));
+            auto lua = it->find("lua");
+            if (lua != it->end()) {
+                std::string text;
+                for (auto line = lua->begin(); line != lua->end(); ++line) {
+                    text += line->get<std::string>();
+                    text += "\n";
+                }
+                _derivedColumns.push_back(_formats.size());
+                _luaColumnNames.push_back({});
+                derivedScripts.push_back(text);
+                _formats.push_back({name, -1, indexed, autosize, text, order});
+            } else {
+                auto group = (*it)["group"].get<int>();
+                _luaColumnNames.push_back(name);
+                _formats.push_back({name, group, indexed, autosize, {}, order});
+            }
+        }
+
+        if (!_derivedColumns.empty()) {
+            _derivedScript = makeDerivedColumnsScript(derivedScripts);
+            LuaThread thread;
+            if (!thread.pushScript(_derivedScript))
+                throw std::runtime_error("lua script syntax error");
         }
 
         auto colors = j["colors"];
@@ -166,6 +267,8 @@ void RegexLineParser::load(std::string config) {
 
     int groupCount = pcre2_get_ovector_count(matchData.get());
     for (auto& format : _formats) {
+        if (!format.lua.empty())
+            continue;
         if (format.group < 0 || format.group >= groupCount)
             throw RegexpOutOfBoundGroupReferenceException(fmt::format(
                 "Column \"{}\" references a nonexistent group \"{}\" (there are only {} groups in the regex).",
@@ -175,13 +278,10 @@ void RegexLineParser::load(std::string config) {
     }
 }
 
-bool RegexLineParser::parseLine(std::string_view line,
+bool RegexLineParser::matchLine(std::string_view line,
                                 std::vector<std::string>& columns,
-                                ILineParserContext& context) {
-
-    auto typedContext = dynamic_cast<RegexLineParserContext*>(&context);
-    assert(typedContext);
-    auto matchData = typedContext->matchData.get();
+                                RegexLineParserContext& context) {
+    auto matchData = context.matchData.get();
 
     auto rc = pcre2_jit_match(_re.get(),
                               (PCRE2_SPTR8)line.data(),
@@ -199,19 +299,94 @@ bool RegexLineParser::parseLine(std::string_view line,
     int c = 0;
     for (auto& format : _formats) {
         auto i = format.group;
+        if (i == -1) {
+            ++c;
+            continue;
+        }
         assert(static_cast<size_t>(i) < pcre2_get_ovector_count(matchData));
-        auto group = line.data() + vec[2 * i];
-        auto len = vec[2 * i + 1] - vec[2 * i];
-        columns[c].assign(group, len);
+        if (vec[2 * i] == PCRE2_UNSET) {
+            // the group belongs to an alternative or an optional part that didn't participate
+            columns[c].clear();
+        } else {
+            auto group = line.data() + vec[2 * i];
+            auto len = vec[2 * i + 1] - vec[2 * i];
+            columns[c].assign(group, len);
+        }
         ++c;
     }
     return true;
 }
 
+void RegexLineParser::computeDerivedColumns(std::vector<std::vector<std::string>*>& rows,
+                                            RegexLineParserContext& context) {
+    if (rows.empty())
+        return;
+
+    auto& values = context.derivedValues;
+    values.resize(rows.size() * _derivedColumns.size());
+
+    LuaRowArray luaRows(_luaColumnNames, rows);
+    context.lua->pushScript(context.derivedScript);
+    context.lua->push(luaRows);
+    if (context.lua->execTop(1)) {
+        context.lua->popStrings(values);
+    } else {
+        std::fill(begin(values), end(values), std::string());
+    }
+
+    auto value = begin(values);
+    for (auto row : rows) {
+        for (auto column : _derivedColumns) {
+            (*row)[column] = std::move(*value++);
+        }
+    }
+}
+
+bool RegexLineParser::parseLine(std::string_view line,
+                                std::vector<std::string>& columns,
+                                ILineParserContext& context) {
+
+    auto typedContext = dynamic_cast<RegexLineParserContext*>(&context);
+    assert(typedContext);
+
+    if (!matchLine(line, columns, *typedContext))
+        return false;
+
+    if (!_derivedColumns.empty()) {
+        auto& rows = typedContext->rows;
+        rows.assign(1, &columns);
+        computeDerivedColumns(rows, *typedContext);
+    }
+    return true;
+}
+
+void RegexLineParser::parseLines(const std::vector<std::string_view>& lines,
+                                 std::vector<std::vector<std::string>>& columns,
+                                 std::vector<bool>& parsed,
+                                 ILineParserContext& context) {
+    auto typedContext = dynamic_cast<RegexLineParserContext*>(&context);
+    assert(typedContext);
+
+    columns.resize(lines.size());
+    parsed.resize(lines.size());
+    auto& rows = typedContext->rows;
+    rows.clear();
+    for (auto i = 0u; i < lines.size(); ++i) {
+        parsed[i] = matchLine(lines[i], columns[i], *typedContext);
+        if (parsed[i]) {
+            rows.push_back(&columns[i]);
+        }
+    }
+
+    if (!_derivedColumns.empty()) {
+        computeDerivedColumns(rows, *typedContext);
+    }
+}
+
 std::vector<ColumnFormat> RegexLineParser::getColumnFormats() {
     std::vector<ColumnFormat> formats;
     for (auto& format : _formats) {
-        formats.push_back({format.name, format.indexed, format.autosize});
+        formats.push_back({format.name, format.indexed, format.autosize, format.order});
     }
     return formats;
 }
@@ -225,6 +400,10 @@ uint32_t RegexLineParser::rgb(const std::vector<std::string>& columns) const {
     return 0;
 }
 
+bool RegexLineParser::trigramIndex() const {
+    return _trigramIndex;
+}
+
 bool RegexLineParser::isMatch(const std::vector<std::string>& sample,
                               std::string_view fileName) {
     return _detector->isMatch(sample, fileName);
@@ -235,6 +414,12 @@ std::unique_ptr<ILineParserContext> RegexLineParser::createContext() const {
     context->matchData = std::shared_ptr<pcre2_match_data>(
         pcre2_match_data_create_from_pattern(_re.get(), nullptr),
         pcre2_match_data_free);
+    if (!_derivedColumns.empty()) {
+        context->lua = std::make_unique<LuaThread>();
+        auto ref = context->lua->loadScript(_derivedScript);
+        assert(ref);
+        context->derivedScript = *ref;
+    }
     return context;
 }
 
@@ -11,6 +11,8 @@ struct pcre2_real_code_8;
 
 namespace seer {
 
+class RegexLineParserContext;
+
 struct RegexColumnColor {
     int column;
     std::string value;
@@ -22,6 +24,8 @@ struct RegexColumnFormat {
     int group;
     bool indexed;
     bool autosize;
+    std::string lua;
+    ValueOrder order;
 };
 
 class JsonParserException : public std::runtime_error {
@@ -52,14 +56,29 @@ class RegexLineParser : public ILineParser {
     std::shared_ptr<ILogDetector> _detector;
     std::string _name;
     std::shared_ptr<pcre2_real_code_8> _re;
+    std::vector<int> _derivedColumns;
+    std::vector<std::string> _luaColumnNames;
+    std::string _derivedScript;
+    bool _trigramIndex = false;
+
+    bool matchLine(std::string_view line,
+                   std::vector<std::string>& columns,
+                   RegexLineParserContext& context);
+    void computeDerivedColumns(std::vector<std::vector<std::string>*>& rows,
+                               RegexLineParserContext& context);
 
 public:
     RegexLineParser(std::string name);
     void load(std::string config);
     bool parseLine(std::string_view line, std::vector<std::string> &columns, ILineParserContext& context) override;
+    void parseLines(const std::vector<std::string_view>& lines,
+                    std::vector<std::vector<std::string>>& columns,
+                    std::vector<bool>& parsed,
+                    ILineParserContext& context) override;
     std::vector<ColumnFormat> getColumnFormats() override;
     bool isMatch(const std::vector<std::string>& sample, std::string_view fileName) override;
     uint32_t rgb(const std::vector<std::string>& columns) const override;
+    bool trigramIndex() const override;
     std::unique_ptr<ILineParserContext> createContext() const override;
     std::string name() const override;
 };
@@ -1,5 +1,9 @@
 #include "Searcher.h"
+#include "CaselessFinder.h"
 #include <assert.h>
+#include <atomic>
+#include <string_view>
+#include <vector>
 
 #define PCRE2_CODE_UNIT_WIDTH 8
 #include <pcre2.h>
@@ -12,83 +16,115 @@ template <class S>
 struct Traits;
 
 template <>
-struct Traits<QString> {
-    using CharPtr = PCRE2_SPTR16;
-    using ReType = pcre2_code_16;
-    using MatchData = pcre2_match_data_16;
+struct Traits<std::string> {
+    using CharPtr = PCRE2_SPTR8;
+    using ReType = pcre2_code_8;
+    using MatchData = pcre2_match_data_8;
+    using MatchContext = pcre2_match_context_8;
 
     template <class... Args>
     static ReType* Compile(Args... args) {
-        return pcre2_compile_16(std::forward<Args>(args)...);
+        return pcre2_compile_8(std::forward<Args>(args)...);
     }
 
     template <class... Args>
     static auto JitCompile(Args... args) {
-        return pcre2_jit_compile_16(std::forward<Args>(args)...);
+        return pcre2_jit_compile_8(std::forward<Args>(args)...);
     }
 
     template <class... Args>
     static auto CreateMatchDataFromPattern(Args... args) {
-        return pcre2_match_data_create_from_pattern_16(std::forward<Args>(args)...);
+        return pcre2_match_data_create_from_pattern_8(std::forward<Args>(args)...);
     }
 
     template <class... Args>
     static auto MatchDataFree(Args... args) {
-        return pcre2_match_data_free_16(std::forward<Args>(args)...);
+        return pcre2_match_data_free_8(std::forward<Args>(args)...);
     }
 
     template <class... Args>
     static auto JitMatch(Args... args) {
-        return pcre2_jit_match_16(std::forward<Args>(args)...);
+        return pcre2_jit_match_8(std::forward<Args>(args)...);
     }
 
     template <class... Args>
     static auto GetOvectorPointer(Args... args) {
-        return pcre2_get_ovector_pointer_16(std::forward<Args>(args)...);
-    }
-};
-
-template <>
-struct Traits<std::string> {
-    using CharPtr = PCRE2_SPTR8;
-    using ReType = pcre2_code_8;
-    using MatchData = pcre2_match_data_8;
-
-    template <class... Args>
-    static ReType* Compile(Args... args) {
-        return pcre2_compile_8(std::forward<Args>(args)...);
+        return pcre2_get_ovector_pointer_8(std::forward<Args>(args)...);
     }
 
     template <class... Args>
-    static auto JitCompile(Args... args) {
-        return pcre2_jit_compile_8(std::forward<Args>(args)...);
+    static auto DfaMatch(Args... args) {
+        return pcre2_dfa_match_8(std::forward<Args>(args)...);
     }
 
     template <class... Args>
-    static auto CreateMatchDataFromPattern(Args... args) {
-        return pcre2_match_data_create_from_pattern_8(std::forward<Args>(args)...);
+    static auto MatchContextCreate(Args... args) {
+        return pcre2_match_context_create_8(std::forward<Args>(args)...);
     }
 
     template <class... Args>
-    static auto MatchDataFree(Args... args) {
-        return pcre2_match_data_free_8(std::forward<Args>(args)...);
+    static auto MatchContextFree(Args... args) {
+        return pcre2_match_context_free_8(std::forward<Args>(args)...);
     }
 
     template <class... Args>
-    static auto JitMatch(Args... args) {
-        return pcre2_jit_match_8(std::forward<Args>(args)...);
+    static auto SetMatchLimit(Args... args) {
+        return pcre2_set_match_limit_8(std::forward<Args>(args)...);
     }
 
     template <class... Args>
-    static auto GetOvectorPointer(Args... args) {
-        return pcre2_get_ovector_pointer_8(std::forward<Args>(args)...);
+    static auto SetDepthLimit(Args... args) {
+        return pcre2_set_depth_limit_8(std::forward<Args>(args)...);
     }
 };
 
+std::atomic<RegexEngine> g_regexEngine = RegexEngine::Backtracking;
+
+bool isLimitError(int rc) {
+    return rc == PCRE2_ERROR_MATCHLIMIT
+        || rc == PCRE2_ERROR_DEPTHLIMIT
+        || rc == PCRE2_ERROR_HEAPLIMIT
+        || rc == PCRE2_ERROR_JIT_STACKLIMIT
+        || rc == PCRE2_ERROR_DFA_WSSIZE
+        || rc == PCRE2_ERROR_DFA_RECURSE;
+}
+
+// the DFA algorithm reports the items it can't handle, like backreferences, when matching
+bool isDfaUnsupported(int rc) {
+    return rc == PCRE2_ERROR_DFA_UCOND
+        || rc == PCRE2_ERROR_DFA_UFUNC
+        || rc == PCRE2_ERROR_DFA_UITEM
+        || rc == PCRE2_ERROR_DFA_UINVALID_UTF;
+}
+
 template <class S>
 class RegexSearcher {
     typename Traits<S>::ReType* _re;
     std::shared_ptr<typename Traits<S>::MatchData> _matchData;
+    std::shared_ptr<typename Traits<S>::MatchContext> _matchContext;
+    std::vector<int> _dfaWorkspace;
+    bool _dfa = false;
+    uint64_t _limitHits = 0;
+
+    int match(const S& text, size_t start) {
+        auto subject = reinterpret_cast<typename Traits<S>::CharPtr>(text.data());
+        if (_dfa) {
+            auto rc = Traits<S>::DfaMatch(_re,
+                                          subject,
+                                          text.size(),
+                                          start,
+                                          0,
+                                          _matchData.get(),
+                                          _matchContext.get(),
+                                          _dfaWorkspace.data(),
+                                          _dfaWorkspace.size());
+            if (!isDfaUnsupported(rc))
+                return rc;
+            _dfa = false;
+        }
+        return Traits<S>::JitMatch(
+            _re, subject, text.size(), start, 0, _matchData.get(), _matchContext.get());
+    }
 
 public:
     RegexSearcher(const S& pattern, bool regex, bool caseSensitive, bool unicodeAware) {
@@ -111,6 +147,17 @@ public:
         _matchData = std::shared_ptr<typename Traits<S>::MatchData>(
             Traits<S>::CreateMatchDataFromPattern(_re, nullptr),
             [] (auto ptr) { Traits<S>::MatchDataFree(ptr); });
+        _matchContext = std::shared_ptr<typename Traits<S>::MatchContext>(
+            Traits<S>::MatchContextCreate(nullptr),
+            [] (auto ptr) { Traits<S>::MatchContextFree(ptr); });
+        Traits<S>::SetMatchLimit(_matchContext.get(), g_regexMatchLimit);
+        Traits<S>::SetDepthLimit(_matchContext.get(), g_regexDepthLimit);
+
+        // a literal pattern can't backtrack
+        if (regex && g_regexEngine == RegexEngine::Dfa) {
+            _dfa = true;
+            _dfaWorkspace.resize(g_dfaWorkspaceSize);
+        }
     }
 
     std::tuple<int, int> search(const S& text, size_t start) {
@@ -120,16 +167,14 @@ public:
         if (!_re)
             return {-1, -1};
 
-        auto rc = Traits<S>::JitMatch(_re,
-                                      reinterpret_cast<typename Traits<S>::CharPtr>(text.data()),
-                                      text.size(),
-                                      start,
-                                      0,
-                                      _matchData.get(),
-                                      nullptr);
+        auto rc = match(text, start);
 
-        if (rc < 0)
+        if (rc < 0) {
+            if (isLimitError(rc)) {
+                _limitHits++;
+            }
             return {-1, -1};
+        }
 
         auto vec = Traits<S>::GetOvectorPointer(_matchData.get());
         if (vec[0] >= static_cast<size_t>(text.size()))
@@ -137,6 +182,10 @@ public:
 
         return {vec[0], vec[1] - vec[0]};
     }
+
+    uint64_t limitHits() const {
+        return _limitHits;
+    }
 };
 
 class Searcher : public ISearcher {
@@ -149,34 +198,82 @@ public:
     std::tuple<int, int> search(std::string const& text, size_t start) override {
         return _impl.search(text, start);
     }
+
+    uint64_t limitHits() const override {
+        return _impl.limitHits();
+    }
 };
 
-class HighlightSearcher : public IHighlightSearcher {
-    RegexSearcher<QString> _impl;
+// the non-ASCII characters PCRE2_UTF folds to ASCII letters: Kelvin sign and long s
+bool hasAsciiFoldingCharacters(std::string_view text) {
+    return text.find("\xe2\x84\xaa") != std::string_view::npos
+        || text.find("\xc5\xbf") != std::string_view::npos;
+}
+
+// the longest run of ASCII characters, any caseless match of the pattern contains it
+std::string_view longestAsciiRun(std::string_view pattern) {
+    std::string_view longest;
+    size_t start = 0;
+    for (size_t i = 0; i <= pattern.size(); ++i) {
+        if (i == pattern.size() || static_cast<unsigned char>(pattern[i]) >= 0x80) {
+            if (i - start > longest.size()) {
+                longest = pattern.substr(start, i - start);
+            }
+            start = i + 1;
+        }
+    }
+    return longest;
+}
+
+// A caseless literal is found folding ASCII bytes. With PCRE2_UTF a caseless pattern gets several
+// times slower once a letter has more than two cases, like k and s, the byte folding doesn't. PCRE2
+// is still used where folding bytes isn't enough: a unicode aware pattern that isn't ASCII only has
+// its longest ASCII run looked for, to skip the lines that can't match.
+class CaselessLiteralSearcher : public ISearcher {
+    Searcher _regex;
+    CaselessFinder _finder;
+    bool _exact;
+    bool _checkAsciiFolding;
 
 public:
-    HighlightSearcher(QString pattern, bool regex, bool caseSensitive, bool unicodeAware)
-        : _impl(pattern, regex, caseSensitive, unicodeAware) {}
+    CaselessLiteralSearcher(const std::string& pattern, std::string_view fragment, bool unicodeAware)
+        : _regex(pattern, false, false, unicodeAware),
+          _finder(fragment),
+          _exact(fragment.size() == pattern.size()),
+          _checkAsciiFolding(unicodeAware && fragment.find_first_of("kKsS") != std::string::npos) {}
 
-    std::tuple<int, int> search(QString text, size_t start) override {
-        return _impl.search(text, start);
+    std::tuple<int, int> search(std::string const& text, size_t start) override {
+        if (_checkAsciiFolding && hasAsciiFoldingCharacters(text))
+            return _regex.search(text, start);
+        auto pos = _finder.find(text, start);
+        if (pos == std::string::npos)
+            return {-1, -1};
+        if (!_exact)
+            return _regex.search(text, start);
+        return {pos, _finder.size()};
+    }
+
+    uint64_t limitHits() const override {
+        return _regex.limitHits();
     }
 };
 
 } // namespace
 
+RegexEngine setRegexEngine(RegexEngine engine) {
+    return g_regexEngine.exchange(engine);
+}
+
 std::unique_ptr<ISearcher> createSearcher(std::string const& pattern,
                                           bool regex,
                                           bool caseSensitive,
                                           bool unicodeAware) {
+    if (!regex && !caseSensitive) {
+        auto fragment = unicodeAware ? longestAsciiRun(pattern) : std::string_view(pattern);
+        if (!fragment.empty())
+            return std::make_unique<CaselessLiteralSearcher>(pattern, fragment, unicodeAware);
+    }
     return std::make_unique<Searcher>(pattern, regex, caseSensitive, unicodeAware);
 }
 
-std::unique_ptr<IHighlightSearcher> createHighlightSearcher(QString pattern,
-                                                            bool regex,
-                                                            bool caseSensitive,
-                                                            bool unicodeAware) {
-    return std::make_unique<HighlightSearcher>(pattern, regex, caseSensitive, unicodeAware);
-}
-
 } // namespace seer
@@ -1,30 +1,37 @@
 #pragma once
 
-#include <QString>
 #include <string>
 #include <memory>
 #include <tuple>
+#include <stdint.h>
 
 namespace seer {
 
+// bounds the work a single regex match may do, a line hitting a limit doesn't match
+inline constexpr uint32_t g_regexMatchLimit = 1'000'000;
+inline constexpr uint32_t g_regexDepthLimit = 10'000;
+inline constexpr int g_dfaWorkspaceSize = 1000;
+
+enum class RegexEngine {
+    // PCRE2 JIT, supports everything but may backtrack up to the limits
+    Backtracking,
+    // PCRE2 DFA algorithm, doesn't backtrack; regexes it can't handle fall back to the JIT
+    Dfa
+};
+
+// returns the engine used until now
+RegexEngine setRegexEngine(RegexEngine engine);
+
 struct ISearcher {
     virtual std::tuple<int, int> search(std::string const& text, size_t start) = 0;
+    // the number of searches that gave up after hitting the match or depth limit
+    virtual uint64_t limitHits() const = 0;
     virtual ~ISearcher() = default;
 };
 
-struct IHighlightSearcher {
-    virtual std::tuple<int, int> search(QString text, size_t start) = 0;
-    virtual ~IHighlightSearcher() = default;
-};
-
 std::unique_ptr<ISearcher> createSearcher(std::string const& pattern,
                                           bool regex,
                                           bool caseSensitive,
                                           bool unicodeAware);
 
-std::unique_ptr<IHighlightSearcher> createHighlightSearcher(QString pattern,
-                                                            bool regex,
-                                                            bool caseSensitive,
-                                                            bool unicodeAware);
-
 } // namespace seer
@@ -0,0 +1,88 @@
+#include "TrigramIndex.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace seer {
+
+namespace {
+
+uint32_t fold(char ch) {
+    auto c = static_cast<unsigned char>(ch);
+    return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+template <class F>
+void forEachTrigram(std::string_view text, F f) {
+    if (text.size() < 3)
+        return;
+    auto trigram = (fold(text[0]) << 8) | fold(text[1]);
+    for (auto i = 2u; i < text.size(); ++i) {
+        trigram = ((trigram << 8) | fold(text[i])) & 0xffffff;
+        f(trigram);
+    }
+}
+
+} // namespace
+
+void TrigramIndex::add(uint64_t line, std::string_view text) {
+    forEachTrigram(text, [&](auto trigram) {
+        // setting the same line twice is a no-op
+        _postings[trigram].set(line);
+    });
+}
+
+void TrigramIndex::merge(TrigramIndex& other) {
+    for (auto& [trigram, lines] : other._postings) {
+        auto existing = _postings.find(trigram);
+        if (existing == end(_postings)) {
+            _postings[trigram] = std::move(lines);
+        } else {
+            existing->second = existing->second | lines;
+        }
+    }
+    other._postings.clear();
+}
+
+std::optional<ewah_bitset> TrigramIndex::candidates(std::string_view pattern) const {
+    if (pattern.size() < 3)
+        return {};
+
+    std::vector<uint32_t> trigrams;
+    forEachTrigram(pattern, [&](auto trigram) { trigrams.push_back(trigram); });
+    std::sort(begin(trigrams), end(trigrams));
+    trigrams.erase(std::unique(begin(trigrams), end(trigrams)), end(trigrams));
+
+    std::vector<const ewah_bitset*> postings;
+    for (auto trigram : trigrams) {
+        auto it = _postings.find(trigram);
+        if (it == end(_postings))
+            return ewah_bitset();
+        postings.push_back(&it->second);
+    }
+
+    // start with the most selective postings to keep the intermediate results small
+    std::sort(begin(postings), end(postings), [](auto left, auto right) {
+        return left->sizeInBytes() < right->sizeInBytes();
+    });
+
+    auto result = *postings[0];
+    for (auto it = begin(postings) + 1; it != end(postings); ++it) {
+        result = result & **it;
+    }
+    return result;
+}
+
+size_t TrigramIndex::postingCount() const {
+    return _postings.size();
+}
+
+size_t TrigramIndex::sizeInBytes() const {
+    size_t size = 0;
+    for (auto& [_, lines] : _postings) {
+        size += lines.sizeInBytes();
+    }
+    return size;
+}
+
+} // namespace seer
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "FilterAlgo.h"
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <stdint.h>
+
+namespace seer {
+
+// Maps every trigram (three consecutive bytes, ASCII letters folded to lower case) to the lines
+// containing it. Intersecting the postings of a pattern's trigrams gives a superset of the lines
+// containing the pattern, which still have to be verified.
+class TrigramIndex {
+    std::unordered_map<uint32_t, ewah_bitset> _postings;
+
+public:
+    void add(uint64_t line, std::string_view text);
+    void merge(TrigramIndex& other);
+    std::optional<ewah_bitset> candidates(std::string_view pattern) const;
+    size_t postingCount() const;
+    size_t sizeInBytes() const;
+};
+
+} // namespace seer
@@ -0,0 +1,44 @@
+#include "ValueOrder.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <optional>
+
+namespace seer {
+
+namespace {
+
+std::optional<double> toNumber(const std::string& value) {
+    double number;
+    auto last = value.data() + value.size();
+    auto [ptr, ec] = std::from_chars(value.data(), last, number);
+    if (ec != std::errc() || ptr != last || !std::isfinite(number))
+        return {};
+    return number;
+}
+
+size_t explicitRank(const std::vector<std::string>& values, const std::string& value) {
+    return std::distance(begin(values), std::ranges::find(values, value));
+}
+
+} // namespace
+
+bool ValueOrder::less(const std::string& left, const std::string& right) const {
+    if (kind == Kind::Numeric) {
+        auto leftNumber = toNumber(left);
+        auto rightNumber = toNumber(right);
+        if (leftNumber.has_value() != rightNumber.has_value())
+            return leftNumber.has_value();
+        if (leftNumber && *leftNumber != *rightNumber)
+            return *leftNumber < *rightNumber;
+    } else if (kind == Kind::Explicit) {
+        auto leftRank = explicitRank(values, left);
+        auto rightRank = explicitRank(values, right);
+        if (leftRank != rightRank)
+            return leftRank < rightRank;
+    }
+    return left < right;
+}
+
+} // namespace seer
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace seer {
+
+// How the values of an indexed column compare in range filters. Numeric values compare as numbers
+// and come before the values that aren't numbers, an explicit order lists the values from the
+// lowest and the values it doesn't list come after all of them. Ties are lexicographic.
+struct ValueOrder {
+    enum class Kind { Lexicographic, Numeric, Explicit };
+
+    Kind kind = Kind::Lexicographic;
+    std::vector<std::string> values;
+
+    bool less(const std::string& left, const std::string& right) const;
+};
+
+} // namespace seer
@@ -6,6 +6,13 @@
 
 namespace seer {
 
+constexpr int g_deadlineCheckInstructions = 1000;
+
+static const char* errorMessage(lua_State* l) {
+    auto message = lua_tostring(l, -1);
+    return message ? message : "";
+}
+
 void LuaInt::push(lua_State* l) {
     lua_pushinteger(l, _value);
 }
@@ -37,18 +44,62 @@ void LuaTable::insert(LuaObjectS key, LuaObjectS value) {
     _fields.push_back({key, value});
 }
 
+void LuaLineArray::push(lua_State* l) {
+    lua_createtable(l, _lines.size(), 0);
+    for (auto i = 0u; i < _lines.size(); ++i) {
+        lua_createtable(l, 0, 2);
+        lua_pushlstring(l, _lines[i].data(), _lines[i].size());
+        lua_setfield(l, -2, "text");
+        lua_pushboolean(l, _parsed[i]);
+        lua_setfield(l, -2, "parsed");
+        lua_rawseti(l, -2, i);
+    }
+}
+
+LuaLineArray::LuaLineArray(const std::vector<std::string>& lines, const std::vector<bool>& parsed)
+    : _lines(lines), _parsed(parsed) {}
+
+void LuaRowArray::push(lua_State* l) {
+    lua_createtable(l, _rows.size(), 0);
+    for (auto i = 0u; i < _rows.size(); ++i) {
+        const auto& row = *_rows[i];
+        lua_createtable(l, 0, _names.size());
+        for (auto c = 0u; c < _names.size() && c < row.size(); ++c) {
+            if (_names[c].empty())
+                continue;
+            lua_pushlstring(l, row[c].data(), row[c].size());
+            lua_setfield(l, -2, _names[c].c_str());
+        }
+        lua_rawseti(l, -2, i + 1);
+    }
+}
+
+LuaRowArray::LuaRowArray(const std::vector<std::string>& names,
+                         const std::vector<std::vector<std::string>*>& rows)
+    : _names(names), _rows(rows) {}
+
+void LuaThread::checkDeadline(lua_State* l, lua_Debug*) {
+    auto thread = *static_cast<LuaThread**>(lua_getextraspace(l));
+    if (std::chrono::steady_clock::now() > thread->_deadline) {
+        luaL_error(l, "time limit of %d ms exceeded", static_cast<int>(thread->_timeout.count()));
+    }
+}
+
 LuaThread::~LuaThread() {
     lua_close(_state);
 }
 
 LuaThread::LuaThread() {
     _state = luaL_newstate();
+    *static_cast<LuaThread**>(lua_getextraspace(_state)) = this;
     luaL_openlibs(_state);
 }
 
-bool LuaThread::execTop() {
-    if (auto err = lua_pcall(_state, 0, 1, 0); err) {
-        log_infof("lua_pcall error: {}", err);
+bool LuaThread::execTop(int argCount) {
+    _deadline = std::chrono::steady_clock::now() + _timeout;
+    if (auto err = lua_pcall(_state, argCount, 1, 0); err) {
+        log_infof("lua_pcall error: {} ({})", err, errorMessage(_state));
+        lua_pop(_state, 1);
         return false;
     }
     return true;
@@ -56,12 +107,31 @@ bool LuaThread::execTop() {
 
 bool LuaThread::pushScript(const std::string& text) {
     if (auto err = luaL_loadbuffer(_state, text.c_str(), text.size(), ""); err) {
-        log_infof("luaL_loadbuffer error: {}", err);
+        log_infof("luaL_loadbuffer error: {} ({})", err, errorMessage(_state));
+        lua_pop(_state, 1);
         return false;
     }
     return true;
 }
 
+std::optional<int> LuaThread::loadScript(const std::string& text) {
+    if (!pushScript(text))
+        return {};
+    return luaL_ref(_state, LUA_REGISTRYINDEX);
+}
+
+void LuaThread::pushScript(int ref) {
+    lua_rawgeti(_state, LUA_REGISTRYINDEX, ref);
+}
+
+void LuaThread::setTimeout(std::chrono::milliseconds timeout) {
+    _timeout = timeout;
+    lua_sethook(_state,
+                timeout.count() ? checkDeadline : nullptr,
+                timeout.count() ? LUA_MASKCOUNT : 0,
+                g_deadlineCheckInstructions);
+}
+
 void LuaThread::push(LuaObject& object) {
     object.push(_state);
 }
@@ -72,7 +142,20 @@ void LuaThread::setGlobal(const std::string& name, LuaObject& value) {
 }
 
 bool LuaThread::popBool() {
-    return lua_toboolean(_state, 1);
+    auto value = lua_toboolean(_state, -1);
+    lua_pop(_state, 1);
+    return value;
+}
+
+void LuaThread::popStrings(std::vector<std::string>& values) {
+    for (auto i = 0u; i < values.size(); ++i) {
+        lua_rawgeti(_state, -1, i + 1);
+        size_t len = 0;
+        auto str = lua_tolstring(_state, -1, &len);
+        values[i].assign(str ? str : "", str ? len : 0);
+        lua_pop(_state, 1);
+    }
+    lua_pop(_state, 1);
 }
 
 } // namespace seer
@@ -10,6 +10,8 @@ extern "C" {
 #include <string>
 #include <memory>
 #include <vector>
+#include <chrono>
+#include <optional>
 
 namespace seer {
 
@@ -56,16 +58,44 @@ public:
     void insert(LuaObjectS key, LuaObjectS value);
 };
 
+class LuaLineArray : public LuaObject {
+    const std::vector<std::string>& _lines;
+    const std::vector<bool>& _parsed;
+protected:
+    void push(lua_State* l) override;
+public:
+    LuaLineArray(const std::vector<std::string>& lines, const std::vector<bool>& parsed);
+};
+
+class LuaRowArray : public LuaObject {
+    const std::vector<std::string>& _names;
+    const std::vector<std::vector<std::string>*>& _rows;
+protected:
+    void push(lua_State* l) override;
+public:
+    LuaRowArray(const std::vector<std::string>& names,
+                const std::vector<std::vector<std::string>*>& rows);
+};
+
 class LuaThread {
     lua_State* _state = nullptr;
+    std::chrono::milliseconds _timeout{0};
+    std::chrono::steady_clock::time_point _deadline;
+    static void checkDeadline(lua_State* l, lua_Debug* debug);
 public:
     ~LuaThread();
     LuaThread();
-    bool execTop();
+    LuaThread(const LuaThread&) = delete;
+    LuaThread& operator=(const LuaThread&) = delete;
+    bool execTop(int argCount = 0);
     bool pushScript(const std::string& text);
+    std::optional<int> loadScript(const std::string& text);
+    void pushScript(int ref);
+    void setTimeout(std::chrono::milliseconds timeout);
     void push(LuaObject& object);
     void setGlobal(const std::string& name, LuaObject& value);
     bool popBool();
+    void popStrings(std::vector<std::string>& values);
 };
 
 } // namespace seer
@@ -0,0 +1,43 @@
+#include "FilteringTask.h"
+
+#include "gui/Config.h"
+#include "seer/Stopwatch.h"
+#include "seer/Log.h"
+
+#include <fmt/chrono.h>
+
+namespace seer::task {
+
+FilteringTask::FilteringTask(Index* index,
+                             std::vector<ColumnFilter> filters,
+                             std::vector<int> valueColumns)
+    : _index(std::make_shared<Index>(*index)),
+      _filters(std::move(filters)),
+      _valueColumns(std::move(valueColumns)) {}
+
+std::shared_ptr<Index> FilteringTask::index() {
+    return _index;
+}
+
+void FilteringTask::body() {
+    Stopwatch sw;
+
+    auto maxThreads = gui::g_Config.generalConfig().maxThreads;
+    if (!_index->filter(_filters, [this] { return isStopRequested(); }, maxThreads)) {
+        log_infof("filtering stopped after {}", sw.msElapsed());
+        reportStopped();
+        return;
+    }
+
+    for (auto column : _valueColumns) {
+        if (isStopRequested()) {
+            reportStopped();
+            return;
+        }
+        _index->getValues(column, maxThreads);
+    }
+
+    log_infof("filtering task finished in {}", sw.msElapsed());
+}
+
+} // namespace seer::task
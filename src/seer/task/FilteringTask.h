@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Task.h"
+#include "seer/Index.h"
+#include <vector>
+#include <memory>
+
+namespace seer {
+namespace task {
+
+// filters a copy of the index so that the current one stays usable until the new one is ready
+class FilteringTask : public Task {
+    std::shared_ptr<Index> _index;
+    std::vector<ColumnFilter> _filters;
+    std::vector<int> _valueColumns;
+
+public:
+    // the values of valueColumns are counted ahead so that the filter views don't have to
+    FilteringTask(Index* index, std::vector<ColumnFilter> filters, std::vector<int> valueColumns);
+    std::shared_ptr<Index> index();
+
+protected:
+    void body() override;
+};
+
+} // namespace task
+} // namespace seer
@@ -0,0 +1,55 @@
+#include "FindingTask.h"
+
+#include "gui/Config.h"
+#include "seer/Index.h"
+#include "seer/Stopwatch.h"
+#include "seer/Log.h"
+
+#include <fmt/chrono.h>
+
+namespace seer::task {
+
+FindingTask::FindingTask(FileParser* fileParser,
+                         Index* index,
+                         std::optional<uint64_t> row,
+                         bool backward,
+                         std::string text,
+                         bool regex,
+                         bool caseSensitive,
+                         bool unicodeAware,
+                         bool messageOnly)
+    : _fileParser(fileParser),
+      _index(std::make_shared<Index>(*index)),
+      _row(row),
+      _backward(backward),
+      _text(text),
+      _regex(regex),
+      _caseSensitive(caseSensitive),
+      _unicodeAware(unicodeAware),
+      _messageOnly(messageOnly) {}
+
+std::optional<uint64_t> FindingTask::result() const {
+    return _result;
+}
+
+void FindingTask::body() {
+    Stopwatch sw;
+
+    _result = _index->find(_fileParser,
+                           _row,
+                           _backward,
+                           _text,
+                           _regex,
+                           _caseSensitive,
+                           _unicodeAware,
+                           _messageOnly,
+                           [this] { return isStopRequested(); },
+                           gui::g_Config.generalConfig().maxThreads);
+
+    log_infof("find {} finished in {}", _backward ? "previous" : "next", sw.msElapsed());
+
+    if (isStopRequested())
+        reportStopped();
+}
+
+} // namespace seer::task
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Task.h"
+#include <string>
+#include <memory>
+#include <optional>
+#include <stdint.h>
+
+namespace seer {
+
+class Index;
+class FileParser;
+
+namespace task {
+
+class FindingTask : public Task {
+    FileParser* _fileParser;
+    std::shared_ptr<Index> _index;
+    std::optional<uint64_t> _row;
+    bool _backward;
+    std::string _text;
+    bool _regex;
+    bool _caseSensitive;
+    bool _unicodeAware;
+    bool _messageOnly;
+    std::optional<uint64_t> _result;
+
+public:
+    FindingTask(FileParser* fileParser,
+                Index* index,
+                std::optional<uint64_t> row,
+                bool backward,
+                std::string text,
+                bool regex,
+                bool caseSensitive,
+                bool unicodeAware,
+                bool messageOnly);
+    std::optional<uint64_t> result() const;
+
+protected:
+    void body() override;
+};
+
+} // namespace task
+} // namespace seer
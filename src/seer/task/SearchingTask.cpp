@@ -1,27 +1,37 @@
 #include "SearchingTask.h"
 
+#include "gui/Config.h"
 #include "seer/Index.h"
 #include "seer/Stopwatch.h"
 #include "seer/Log.h"
 
 #include <fmt/chrono.h>
+#include <optional>
 
 namespace seer::task {
 
+constexpr std::chrono::milliseconds g_resultsReportInterval{100};
+
 SearchingTask::SearchingTask(FileParser* fileParser,
                              Index* index,
                              std::string text,
                              bool regex,
                              bool caseSensitive,
                              bool unicodeAware,
-                             bool messageOnly)
+                             bool messageOnly,
+                             int column,
+                             std::shared_ptr<Index> previousSearch)
     : _fileParser(fileParser),
       _text(text),
       _regex(regex),
       _caseSensitive(caseSensitive),
       _unicodeAware(unicodeAware),
       _messageOnly(messageOnly),
-      _index(std::make_shared<Index>(*index)) {}
+      _column(column),
+      // the copy shares the columns with the index, only the filter state is copied
+      _index(std::make_shared<Index>(*index)),
+      _previousSearch(previousSearch),
+      _hist(std::make_shared<Hist>(3000)) {}
 
 std::shared_ptr<Index> SearchingTask::index() {
     return _index;
@@ -31,11 +41,48 @@ std::shared_ptr<Hist> SearchingTask::hist() {
     return _hist;
 }
 
+void SearchingTask::setResultsChanged(std::function<void()> handler) {
+    _resultsChanged = handler;
+}
+
+// the first results are reported right away, later ones are throttled
+void SearchingTask::reportResults() {
+    auto results = _index->getLineCount();
+    if (results == _reportedResults)
+        return;
+    if (_reportedResults && _sinceResultsReported.msElapsed() < g_resultsReportInterval)
+        return;
+    _reportedResults = results;
+    _sinceResultsReported.reset();
+    if (_resultsChanged)
+        _resultsChanged();
+}
+
 void SearchingTask::body() {
-    _hist = std::make_shared<Hist>(3000);
     log_info("search started");
     Stopwatch sw;
 
+    if (_column != -1) {
+        auto result = _index->searchColumn(_fileParser,
+                                           _column,
+                                           _text,
+                                           _regex,
+                                           _caseSensitive,
+                                           _unicodeAware,
+                                           *_hist,
+                                           [this] { return isStopRequested(); });
+        log_infof("column search finished in {}", sw.msElapsed());
+        if (!result)
+            reportStopped();
+        return;
+    }
+
+    std::optional<ewah_bitset> scope;
+    if (_previousSearch) {
+        scope = _previousSearch->searchResults();
+        _previousSearch.reset();
+    }
+
     auto result = _index->search(
         _fileParser,
         _text,
@@ -45,7 +92,12 @@ void SearchingTask::body() {
         _messageOnly,
         *_hist,
         [this] { return isStopRequested(); },
-        [&](auto done, auto total) { reportProgress((done * 100) / total); });
+        [&](auto done, auto total) {
+            reportProgress((done * 100) / total);
+            reportResults();
+        },
+        gui::g_Config.generalConfig().maxThreads,
+        scope ? &*scope : nullptr);
 
     log_infof("search finished in {}", sw.msElapsed());
 
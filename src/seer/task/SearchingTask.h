@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Task.h"
+#include "seer/Stopwatch.h"
+#include <functional>
 #include <string>
 #include <memory>
 
@@ -19,8 +21,15 @@ class SearchingTask : public Task {
     bool _caseSensitive;
     bool _unicodeAware;
     bool _messageOnly;
+    int _column;
     std::shared_ptr<Index> _index;
+    std::shared_ptr<Index> _previousSearch;
     std::shared_ptr<Hist> _hist;
+    std::function<void()> _resultsChanged;
+    uint64_t _reportedResults = 0;
+    Stopwatch _sinceResultsReported;
+
+    void reportResults();
 
 public:
     SearchingTask(FileParser* fileParser,
@@ -29,9 +38,12 @@ public:
                   bool regex,
                   bool caseSensitive,
                   bool unicodeAware,
-                  bool messageOnly);
+                  bool messageOnly,
+                  int column = -1,
+                  std::shared_ptr<Index> previousSearch = {});
     std::shared_ptr<Index> index();
     std::shared_ptr<Hist> hist();
+    void setResultsChanged(std::function<void()> handler);
 
 protected:
     void body() override;
@@ -429,4 +429,199 @@ TEST_CASE("lua_detect_by_content") {
 
     REQUIRE( parser.isMatch({"A", "B", "A"}, "") );
     REQUIRE( !parser.isMatch({"B", "B", "A"}, "") );
-}
\ No newline at end of file
+}
+
+TEST_CASE("lua_detector_timeout") {
+    auto json =
+        R"_(
+            {
+                "description": "test description",
+                "regex": "(A|B)",
+                "detector": [
+                    "if lines[0].text == 'A' then",
+                    "    while true do end",
+                    "end",
+                    "return true"
+                ],
+                "detectorTimeout": 50,
+                "columns": [
+                    {
+                        "name": "message",
+                        "group": 1,
+                        "indexed": false
+                    }
+                ]
+            }
+        )_";
+
+    seer::RegexLineParser parser{""};
+    parser.load(json);
+
+    REQUIRE( !parser.isMatch({"A", "B"}, "") );
+    REQUIRE( parser.isMatch({"B", "A"}, "") );
+    REQUIRE( !parser.isMatch({"A", "A"}, "") );
+}
+
+TEST_CASE("lua_derived_column") {
+    auto json =
+        R"_(
+            {
+                "description": "test description",
+                "regex": "(\\d+) (.*?) (.*)",
+                "columns": [
+                    {
+                        "name": "Latency",
+                        "group": 1
+                    },
+                    {
+                        "name": "Bucket",
+                        "lua": [
+                            "if tonumber(columns.Latency) < 100 then",
+                            "    return 'fast'",
+                            "end",
+                            "return 'slow'"
+                        ],
+                        "indexed": true
+                    },
+                    {
+                        "name": "Endpoint",
+                        "lua": [ "return string.match(columns.Url, '^/[^/?]+')" ],
+                        "indexed": true
+                    },
+                    {
+                        "name": "Url",
+                        "group": 2
+                    },
+                    {
+                        "name": "Message",
+                        "group": 3
+                    }
+                ]
+            }
+        )_";
+
+    seer::RegexLineParser parser{""};
+    parser.load(json);
+
+    auto formats = parser.getColumnFormats();
+    REQUIRE( formats.size() == 5 );
+    REQUIRE( formats[1].header == "Bucket" );
+    REQUIRE( formats[1].indexed );
+
+    auto context = parser.createContext();
+    std::vector<std::string> columns;
+    REQUIRE( parser.parseLine("15 /api/users?id=1 done", columns, *context) );
+    REQUIRE( columns == std::vector<std::string>{"15", "fast", "/api", "/api/users?id=1", "done"} );
+
+    std::vector<std::string_view> lines{"250 /static/a.js ok", "garbage", "99 /health ok"};
+    std::vector<std::vector<std::string>> rows;
+    std::vector<bool> parsed;
+    parser.parseLines(lines, rows, parsed, *context);
+    REQUIRE( parsed == std::vector<bool>{true, false, true} );
+    REQUIRE( rows[0][1] == "slow" );
+    REQUIRE( rows[0][2] == "/static" );
+    REQUIRE( rows[2][1] == "fast" );
+    REQUIRE( rows[2][2] == "/health" );
+}
+
+TEST_CASE("lua_derived_column_errors") {
+    auto json =
+        R"_(
+            {
+                "description": "test description",
+                "regex": "(\\w+) (.*?) (.*)",
+                "columns": [
+                    {
+                        "name": "Latency",
+                        "group": 1
+                    },
+                    {
+                        "name": "Bucket",
+                        "lua": [
+                            "if tonumber(columns.Latency) < 100 then",
+                            "    return 'fast'",
+                            "end",
+                            "return 'slow'"
+                        ]
+                    },
+                    {
+                        "name": "Path",
+                        "lua": [
+                            "while columns.Url == '/loop' do end",
+                            "return columns.Url"
+                        ]
+                    },
+                    {
+                        "name": "Url",
+                        "group": 2
+                    },
+                    {
+                        "name": "Message",
+                        "group": 3
+                    }
+                ]
+            }
+        )_";
+
+    seer::RegexLineParser parser{""};
+    parser.load(json);
+    auto context = parser.createContext();
+
+    // a failing or endless script only empties its own cell, the rest of the batch is unaffected
+    std::vector<std::string_view> lines{"250 /a ok", "abc /b ok", "99 /loop ok"};
+    std::vector<std::vector<std::string>> rows;
+    std::vector<bool> parsed;
+    parser.parseLines(lines, rows, parsed, *context);
+    REQUIRE( parsed == std::vector<bool>{true, true, true} );
+    REQUIRE( rows[0] == std::vector<std::string>{"250", "slow", "/a", "/a", "ok"} );
+    REQUIRE( rows[1] == std::vector<std::string>{"abc", "", "/b", "/b", "ok"} );
+    REQUIRE( rows[2] == std::vector<std::string>{"99", "fast", "", "/loop", "ok"} );
+
+    for (auto i = 0u; i < lines.size(); ++i) {
+        std::vector<std::string> columns;
+        REQUIRE( parser.parseLine(lines[i], columns, *context) );
+        REQUIRE( columns == rows[i] );
+    }
+}
+
+TEST_CASE("regex_alternatives") {
+    auto json =
+        R"_(
+            {
+                "description": "test description",
+                "regex": [
+                    "(\\d+) (\\w+) (.*)",
+                    "()(AUDIT) (.*)",
+                    "(\\d+)-(\\w+)"
+                ],
+                "columns": [
+                    {
+                        "name": "Timestamp",
+                        "group": 1
+                    },
+                    {
+                        "name": "Level",
+                        "group": 2,
+                        "indexed": true
+                    },
+                    {
+                        "name": "Message",
+                        "group": 3
+                    }
+                ]
+            }
+        )_";
+
+    seer::RegexLineParser parser{""};
+    parser.load(json);
+
+    auto context = parser.createContext();
+    std::vector<std::string> columns;
+    REQUIRE( parser.parseLine("10 INFO started", columns, *context) );
+    REQUIRE( columns == std::vector<std::string>{"10", "INFO", "started"} );
+    REQUIRE( parser.parseLine("AUDIT alice logged in", columns, *context) );
+    REQUIRE( columns == std::vector<std::string>{"", "AUDIT", "alice logged in"} );
+    REQUIRE( parser.parseLine("20-WARN", columns, *context) );
+    REQUIRE( columns == std::vector<std::string>{"20", "WARN", ""} );
+    REQUIRE( !parser.parseLine("    at frame.cpp:12", columns, *context) );
+}
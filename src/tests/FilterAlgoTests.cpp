@@ -1,5 +1,8 @@
 #include <catch2/catch.hpp>
 #include <seer/FilterAlgo.h>
+#include <seer/Stopwatch.h>
+#include <fmt/format.h>
+#include <fmt/chrono.h>
 #include <random>
 #include <set>
 #include <numeric>
@@ -84,3 +87,140 @@ TEST_CASE("filter_algo_2") {
     REQUIRE( stats.diffOps == 40 + 150 + 2 );
     REQUIRE( algo.naive() == algo.diff() );
 }
+
+// the share of the lines of value i is proportional to 1 / (i + 1), as with log levels where a few
+// values cover most of the file
+static std::vector<ewah_bitset> initSkewedSets(int lineCount, int valueCount) {
+    std::mt19937 g(1);
+    std::vector<double> weights;
+    for (int i = 0; i < valueCount; ++i) {
+        weights.push_back(1.0 / (i + 1));
+    }
+    std::discrete_distribution<int> value(begin(weights), end(weights));
+
+    std::vector<ewah_bitset> sets(valueCount);
+    for (int line = 0; line < lineCount; ++line) {
+        sets[value(g)].set(line);
+    }
+    return sets;
+}
+
+static std::vector<const ewah_bitset*> selectValues(const std::vector<ewah_bitset>& sets,
+                                                    const std::vector<int>& values) {
+    std::vector<const ewah_bitset*> selected;
+    for (auto value : values) {
+        selected.push_back(&sets[value]);
+    }
+    return selected;
+}
+
+static std::vector<int> valueRange(int first, int last) {
+    std::vector<int> values(last - first);
+    std::iota(begin(values), end(values), first);
+    return values;
+}
+
+TEST_CASE("filter_algo_cost_skewed") {
+    // a value on nearly every line and small values on a few lines at the start
+    const int lineCount = 100000;
+    std::vector<ewah_bitset> sets(12);
+    for (int line = 0; line < lineCount; ++line) {
+        auto value = line < 110 && line % 10 == 0 ? line / 10 + 1 : 0;
+        sets[value].set(line);
+    }
+
+    // few operations but the diff has to go through the largest value twice, while the new
+    // selection is a few small values
+    auto basePtrs = selectValues(sets, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+    auto newPtrs = selectValues(sets, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
+    auto base = fast_logicalor(basePtrs.size(), &basePtrs[0]);
+    FilterAlgo algo(base, basePtrs, newPtrs);
+
+    auto stats = algo.stats();
+    REQUIRE( stats.diffOps < stats.naiveOps );
+    REQUIRE( stats.preferNaive() );
+    REQUIRE( algo.naive() == algo.diff() );
+
+    // swapping two small values out of a selection of many values spread over the file
+    auto skewed = initSkewedSets(lineCount, 50);
+    auto allButOne = valueRange(0, 48);
+    allButOne.push_back(49);
+    basePtrs = selectValues(skewed, valueRange(0, 49));
+    newPtrs = selectValues(skewed, allButOne);
+    base = fast_logicalor(basePtrs.size(), &basePtrs[0]);
+    FilterAlgo swapAlgo(base, basePtrs, newPtrs);
+
+    stats = swapAlgo.stats();
+    REQUIRE( !stats.preferNaive() );
+    REQUIRE( swapAlgo.naive() == swapAlgo.diff() );
+}
+
+TEST_CASE("filter_algo_benchmark", "[.][benchmark]") {
+    struct Case {
+        const char* name;
+        std::vector<int> base;
+        std::vector<int> selected;
+    };
+
+    auto sets = initSkewedSets(10000000, 1000);
+    auto withoutLargest = valueRange(1, 1000);
+    auto largestOnly = std::vector<int>{0};
+    auto smallValues = valueRange(900, 1000);
+    auto largeValues = valueRange(0, 10);
+    auto swapped = valueRange(0, 999);
+    swapped.back() = 999;
+
+    std::vector<Case> cases{
+        {"exclude the largest value", valueRange(0, 1000), withoutLargest},
+        {"include the largest value", withoutLargest, valueRange(0, 1000)},
+        {"only the largest value", valueRange(0, 1000), largestOnly},
+        {"small values after large", largeValues, smallValues},
+        {"swap a small value", valueRange(0, 999), swapped},
+    };
+
+    for (auto& c : cases) {
+        auto basePtrs = selectValues(sets, c.base);
+        auto newPtrs = selectValues(sets, c.selected);
+        auto base = fast_logicalor(basePtrs.size(), &basePtrs[0]);
+        FilterAlgo algo(base, basePtrs, newPtrs);
+        auto stats = algo.stats();
+
+        seer::Stopwatch sw;
+        auto naive = algo.naive();
+        auto naiveTime = sw.msElapsed();
+        sw.reset();
+        auto diff = algo.diff();
+        auto diffTime = sw.msElapsed();
+        REQUIRE( naive == diff );
+
+        fmt::print("{:<28} naive {:>6} ({:>10} cost) diff {:>6} ({:>10} cost) model picks {}\n",
+                   c.name,
+                   naiveTime,
+                   stats.naiveCost,
+                   diffTime,
+                   stats.diffCost,
+                   stats.preferNaive() ? "naive" : "diff");
+    }
+}
+
+TEST_CASE("parallel_or") {
+    auto sets = initSkewedSets(100000, 1000);
+    std::vector<const ewah_bitset*> setPtrs;
+    for (auto& set : sets) {
+        setPtrs.push_back(&set);
+    }
+    auto expected = fast_logicalor(setPtrs.size(), &setPtrs[0]);
+
+    REQUIRE( parallelOr(setPtrs, 1) == expected );
+    REQUIRE( parallelOr(setPtrs, 2) == expected );
+    REQUIRE( parallelOr(setPtrs, 7) == expected );
+    REQUIRE( parallelOr(setPtrs, 64) == expected );
+
+    // the largest set is more than a group's share of the bytes by itself
+    std::reverse(begin(setPtrs), end(setPtrs));
+    REQUIRE( parallelOr(setPtrs, 8) == expected );
+
+    std::vector<const ewah_bitset*> few(begin(setPtrs), begin(setPtrs) + 10);
+    REQUIRE( parallelOr(few, 8) == fast_logicalor(few.size(), &few[0]) );
+    REQUIRE( parallelOr({}, 8).numberOfOnes() == 0 );
+}
@@ -0,0 +1,215 @@
+#include <catch2/catch.hpp>
+#include <seer/FilterExpr.h>
+#include <seer/Index.h>
+#include "TestLineParser.h"
+#include <fmt/format.h>
+#include <sstream>
+
+using namespace seer;
+
+static ewah_bitset makeBitset(std::vector<uint64_t> lines) {
+    ewah_bitset bitset;
+    for (auto line : lines) {
+        bitset.set(line);
+    }
+    return bitset;
+}
+
+static std::vector<uint64_t> toVector(const ewah_bitset& bitset) {
+    return {bitset.begin(), bitset.end()};
+}
+
+TEST_CASE("filter_expr_evaluate") {
+    // column 0 has the values a (lines 0-4) and b (lines 5-9), column 1 has c on the even lines
+    std::map<std::string, ewah_bitset> values{
+        {"a", makeBitset({0, 1, 2, 3, 4})},
+        {"b", makeBitset({5, 6, 7, 8, 9})},
+        {"c", makeBitset({0, 2, 4, 6, 8})},
+    };
+    std::vector<std::string> evaluated;
+    FilterEvaluator evaluator(
+        10,
+        [&](int, auto& selected) {
+            ewah_bitset lines;
+            for (auto& value : selected) {
+                evaluated.push_back(value);
+                lines = lines | values[value];
+            }
+            return lines;
+        },
+        [&](int, auto& selected) {
+            uint64_t count = 0;
+            for (auto& value : selected) {
+                count += values[value].numberOfOnes();
+            }
+            return count;
+        });
+
+    auto a = FilterExpr::columnValues(0, {"a"});
+    auto b = FilterExpr::columnValues(0, {"b"});
+    auto c = FilterExpr::columnValues(1, {"c"});
+
+    REQUIRE( toVector(*evaluator.evaluate(FilterExpr::all({a, c})))
+             == std::vector<uint64_t>{0, 2, 4} );
+    REQUIRE( toVector(*evaluator.evaluate(FilterExpr::any({a, c})))
+             == std::vector<uint64_t>{0, 1, 2, 3, 4, 6, 8} );
+    REQUIRE( toVector(*evaluator.evaluate(FilterExpr::all({b, FilterExpr::negate(c)})))
+             == std::vector<uint64_t>{5, 7, 9} );
+    REQUIRE( toVector(*evaluator.evaluate(FilterExpr::negate(c)))
+             == std::vector<uint64_t>{1, 3, 5, 7, 9} );
+    REQUIRE( toVector(*evaluator.evaluate(FilterExpr::all({FilterExpr::negate(c)})))
+             == std::vector<uint64_t>{1, 3, 5, 7, 9} );
+    REQUIRE( evaluator.evaluate(FilterExpr::all({}))->numberOfOnes() == 10 );
+    REQUIRE( evaluator.evaluate(FilterExpr::any({}))->numberOfOnes() == 0 );
+
+    auto found = std::make_shared<const ewah_bitset>(makeBitset({3, 4, 5}));
+    REQUIRE( toVector(*evaluator.evaluate(FilterExpr::all({a, FilterExpr::lineSet(found)})))
+             == std::vector<uint64_t>{3, 4} );
+
+    REQUIRE( evaluator.estimate(FilterExpr::all({a, c})) == 5 );
+    REQUIRE( evaluator.estimate(FilterExpr::any({a, b, c})) == 10 );
+    REQUIRE( evaluator.estimate(FilterExpr::negate(FilterExpr::lineSet(found))) == 7 );
+
+    // the smallest operand is evaluated first and an empty intersection ends the evaluation
+
+    evaluated.clear();
+    auto none = FilterExpr::columnValues(0, {"none"});
+    REQUIRE( evaluator.evaluate(FilterExpr::all({a, b, none}))->numberOfOnes() == 0 );
+    REQUIRE( evaluated == std::vector<std::string>{"none"} );
+
+    evaluated.clear();
+    REQUIRE( evaluator.evaluate(FilterExpr::all({a, b, c}))->numberOfOnes() == 0 );
+    REQUIRE( evaluated.size() == 2 );
+}
+
+TEST_CASE("filter_expr_stop") {
+    int calls = 0;
+    FilterEvaluator evaluator(
+        10,
+        [](int, auto&) { return makeBitset({1}); },
+        [](int, auto&) { return uint64_t{1}; },
+        [&] { return ++calls > 2; });
+    auto a = FilterExpr::columnValues(0, {"a"});
+    auto b = FilterExpr::columnValues(1, {"b"});
+    auto c = FilterExpr::columnValues(2, {"c"});
+    REQUIRE( !evaluator.evaluate(FilterExpr::any({a, b, c})).has_value() );
+}
+
+TEST_CASE("filter_expr_merge_values") {
+    std::vector<std::tuple<int, std::set<std::string>>> evaluated;
+    FilterEvaluator evaluator(
+        10,
+        [&](int column, auto& values) {
+            evaluated.emplace_back(column, values);
+            return makeBitset({static_cast<uint64_t>(column)});
+        },
+        [](int, auto& values) { return values.size(); });
+
+    // the leaves of the same column are looked up once
+    auto lines = evaluator.evaluate(FilterExpr::any({
+        FilterExpr::columnValues(0, {"a"}),
+        FilterExpr::columnValues(1, {"c"}),
+        FilterExpr::columnValues(0, {"b"}),
+        FilterExpr::columnValues(0, {"a"}),
+    }));
+    REQUIRE( toVector(*lines) == std::vector<uint64_t>{0, 1} );
+    REQUIRE( evaluated.size() == 2 );
+    REQUIRE( evaluated[0] == std::tuple(0, std::set<std::string>{"a", "b"}) );
+    REQUIRE( evaluated[1] == std::tuple(1, std::set<std::string>{"c"}) );
+
+    // the complement of an estimate that is not exact is no upper bound
+    auto a = FilterExpr::columnValues(0, {"a"});
+    auto b = FilterExpr::columnValues(1, {"b"});
+    REQUIRE( evaluator.estimate(FilterExpr::negate(a)) == 9 );
+    REQUIRE( evaluator.estimate(FilterExpr::negate(FilterExpr::any({a, b}))) == 10 );
+    REQUIRE( evaluator.estimate(FilterExpr::negate(FilterExpr::all({a, b}))) == 10 );
+}
+
+TEST_CASE("index_filter_expr") {
+    std::stringstream ss(simpleLog);
+    auto lineParser = createTestParser();
+    FileParser fileParser(&ss, lineParser.get());
+    fileParser.index();
+
+    Index index;
+    index.index(&fileParser, lineParser.get(), 0, []{ return false; }, [](auto, auto){});
+
+    // (level = ERR or level = WARN) and not component = SUB
+    index.filterExpression(FilterExpr::all({
+        FilterExpr::any({FilterExpr::columnValues(1, {"ERR"}),
+                         FilterExpr::columnValues(1, {"WARN"})}),
+        FilterExpr::negate(FilterExpr::columnValues(2, {"SUB"})),
+    }));
+    REQUIRE( index.getLineCount() == 2 );
+    REQUIRE( index.mapIndex(0) == 2 );
+    REQUIRE( index.mapIndex(1) == 4 );
+
+    // the values are counted among the lines the whole expression leaves
+    auto values = index.getValues(1);
+    REQUIRE( values.size() == 3 );
+    REQUIRE( values[0].count == 1 );
+    REQUIRE( values[1].count == 0 );
+    REQUIRE( values[2].count == 1 );
+
+    // the column filters are an AND of the columns and can follow an expression
+    index.filter(std::vector<ColumnFilter>{{1, {"INFO", "ERR"}}, {2, {"CORE"}}});
+    REQUIRE( index.getLineCount() == 2 );
+    REQUIRE( index.mapIndex(0) == 0 );
+    REQUIRE( index.mapIndex(1) == 4 );
+    values = index.getValues(1);
+    REQUIRE( values[0].count == 1 );
+    REQUIRE( values[1].count == 1 );
+    REQUIRE( values[2].count == 1 );
+}
+
+TEST_CASE("index_filter_exclude_value") {
+    std::string log;
+    for (int i = 0; i < 20000; ++i) {
+        log += fmt::format("{} INFO C{} message {}\n", i, i % 5000, i);
+    }
+    std::stringstream ss(log);
+    auto lineParser = createTestParser();
+    FileParser fileParser(&ss, lineParser.get());
+    fileParser.index();
+
+    Index index;
+    index.index(&fileParser, lineParser.get(), 0, []{ return false; }, [](auto, auto){});
+
+    auto names = index.getValueNames(2);
+    std::set<std::string> allButOne(begin(names), end(names));
+    allButOne.erase("C1");
+
+    index.filter(std::vector<ColumnFilter>{{2, allButOne}});
+    REQUIRE( index.getLineCount() == 20000 - 4 );
+    REQUIRE( index.mapIndex(0) == 0 );
+    REQUIRE( index.mapIndex(1) == 2 );
+
+    allButOne.erase("C2");
+    index.filter(std::vector<ColumnFilter>{{2, allButOne}});
+    REQUIRE( index.getLineCount() == 20000 - 8 );
+    REQUIRE( index.mapIndex(1) == 3 );
+
+    // the same exclusion holding only the excluded values
+    index.filter(std::vector<ColumnFilter>{{2, {"C1", "C2"}, true}});
+    REQUIRE( index.getLineCount() == 20000 - 8 );
+    REQUIRE( index.mapIndex(1) == 3 );
+    auto values = index.getValues(2);
+    REQUIRE( values.size() == 5000 );
+    for (auto& value : values) {
+        REQUIRE( value.checked == (value.value != "C1" && value.value != "C2") );
+    }
+
+    // an exclusion is subtracted from the other filters and the values of one column are counted
+    // among the lines the exclusion leaves
+    index.filter(std::vector<ColumnFilter>{{1, {"INFO"}}, {2, {"C0"}, true}});
+    REQUIRE( index.getLineCount() == 20000 - 4 );
+    REQUIRE( index.mapIndex(0) == 1 );
+    REQUIRE( index.getValues(1)[0].count == 20000 - 4 );
+
+    // the same exclusion as an expression
+    index.filterExpression(FilterExpr::all({
+        FilterExpr::negate(FilterExpr::columnValues(2, {"C1", "C2"})),
+    }));
+    REQUIRE( index.getLineCount() == 20000 - 8 );
+    REQUIRE( index.mapIndex(1) == 3 );
+}
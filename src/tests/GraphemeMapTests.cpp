@@ -103,3 +103,21 @@ TEST_CASE("grapheme_map_negative_position") {
     REQUIRE( gmap.graphemeSize() == 3 );
     REQUIRE( gmap.findGrapheme(-100) == 0 );
 }
+
+TEST_CASE("grapheme_map_utf8_bytes") {
+    QString line{u8"g̈1😀b"_as_char}; // 0067 + 0308, 1F600
+    // bytes: ggg1eeeeb
+    // graph: g1eb
+    GraphemeMap gmap(line, &g_singleSizeTestMetrics);
+    REQUIRE( gmap.graphemeSize() == 4 );
+    REQUIRE( gmap.utf8() == line.toStdString() );
+    REQUIRE( gmap.utf8().size() == 9 );
+    REQUIRE( gmap.byteToGrapheme(0) == 0 );
+    REQUIRE( gmap.byteToGrapheme(2) == 0 );
+    REQUIRE( gmap.byteToGrapheme(3) == 1 );
+    REQUIRE( gmap.byteToGrapheme(4) == 2 );
+    REQUIRE( gmap.byteToGrapheme(7) == 2 );
+    REQUIRE( gmap.byteToGrapheme(8) == 3 );
+    REQUIRE( gmap.graphemeToByte(2) == 4 );
+    REQUIRE( gmap.graphemeToByte(4) == 9 );
+}
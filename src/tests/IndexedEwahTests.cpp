@@ -57,3 +57,23 @@ TEST_CASE("indexed_ewah_random") {
         REQUIRE( iewah.get(i) == values[i] );
     }
 }
+
+TEST_CASE("indexed_ewah_get_range") {
+    ewah::EWAHBoolArray<uint64_t> array;
+    std::mt19937 g(1);
+    for (int i = 0; i < 100000;) {
+        array.set(i);
+        i += 1 + g() % 200;
+    }
+    auto values = array.toArray();
+
+    seer::IndexedEwah iewah(256);
+    iewah.init(array);
+    for (uint64_t first : {0, 1, 7, 100, 500}) {
+        std::vector<uint64_t> range(values.size() - first);
+        iewah.getRange(first, range);
+        for (size_t i = 0; i < range.size(); ++i) {
+            REQUIRE( range[i] == values[first + i] );
+        }
+    }
+}
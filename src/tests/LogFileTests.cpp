@@ -237,9 +237,59 @@ TEST_CASE("log_file_filtering") {
     REQUIRE( model->rowCount({}) == 6 );
 
     file.setColumnFilter(2, {"INFO"});
+    waitFor([&] { return !file.isFiltering(); });
     REQUIRE( model->rowCount({}) == 3 );
 }
 
+TEST_CASE("log_file_filtering_latest_filter_wins") {
+    qapp();
+
+    auto file = makeLogFile(simpleLog);
+    waitParsingAndIndexing(file);
+
+    auto model = file.logTableModel();
+
+    file.setColumnFilter(2, {"INFO"});
+    file.setColumnFilter(2, {"WARN"});
+    REQUIRE( file.isFiltering() );
+    waitFor([&] { return !file.isFiltering(); });
+    REQUIRE( model->rowCount({}) == 2 );
+    REQUIRE( model->lineOffset(0) == 2 );
+    REQUIRE( model->lineOffset(1) == 5 );
+
+    // clearing the filter while filtering doesn't wait for the task
+
+    file.setColumnFilter(2, {"INFO"});
+    file.clearFilters();
+    REQUIRE( !file.isFiltering() );
+    REQUIRE( model->rowCount({}) == 6 );
+}
+
+TEST_CASE("log_file_filter_cache") {
+    qapp();
+
+    auto file = makeLogFile(simpleLog);
+    waitParsingAndIndexing(file);
+
+    auto model = file.logTableModel();
+
+    file.setColumnFilter(2, {"INFO"});
+    waitFor([&] { return !file.isFiltering(); });
+    file.setColumnFilter(2, {"WARN"});
+    waitFor([&] { return !file.isFiltering(); });
+    REQUIRE( model->rowCount({}) == 2 );
+
+    // going back to a recent filter doesn't start a task
+    file.setColumnFilter(2, {"INFO"});
+    REQUIRE( !file.isFiltering() );
+    REQUIRE( model->rowCount({}) == 3 );
+    REQUIRE( model->lineOffset(2) == 3 );
+
+    file.clearFilters();
+    REQUIRE( !file.isFiltering() );
+    REQUIRE( model->rowCount({}) == 6 );
+}
+
 TEST_CASE("log_file_multiline") {
     qapp();
 
@@ -337,6 +387,7 @@ TEST_CASE("log_file_search_basic") {
     REQUIRE( model->getRowSelection()->first == 3 );
 
     file.setColumnFilter(2, {"INFO"});
+    waitFor([&] { return !file.isFiltering(); });
     auto selection = model->getRowSelection();
     REQUIRE( selection->first == 2 );
 
@@ -345,6 +396,7 @@ TEST_CASE("log_file_search_basic") {
     // 20 INFO SUB message 4
 
     file.setColumnFilter(2, {});
+    waitFor([&] { return !file.isFiltering(); });
     searchModel->setSelection(0, 0, 0);
     REQUIRE( !model->getRowSelection().has_value() );
 }
@@ -423,6 +475,114 @@ TEST_CASE("log_file_search_regex") {
     REQUIRE( searchModel->rowCount({}) == 0 );
 }
 
+TEST_CASE("log_file_search_refine") {
+    qapp();
+
+    auto file = makeLogFile(simpleLog);
+    waitParsingAndIndexing(file);
+
+    file.search("SUB", false, true, false, false);
+    waitFor([&] { return file.isState(gui::sm::CompleteState); });
+    REQUIRE( file.searchLogTableModel()->rowCount({}) == 3 );
+
+    // 40 WARN SUB message 6
+
+    file.search("SUB message 6", false, true, false, false);
+    waitFor([&] { return file.isState(gui::sm::CompleteState); });
+    REQUIRE( file.searchLogTableModel()->rowCount({}) == 1 );
+    auto hist = file.searchHist();
+    REQUIRE( hist->get(5, 6) == 1 );
+
+    // the previous results were found without a filter and can't be refined
+
+    file.setColumnFilter(2, {"INFO"});
+    file.search("SUB message", false, true, false, false);
+    waitFor([&] { return file.isState(gui::sm::CompleteState); });
+    REQUIRE( file.searchLogTableModel()->rowCount({}) == 2 );
+    hist = file.searchHist();
+    REQUIRE( hist->get(1, 3) == 1 );
+    REQUIRE( hist->get(2, 3) == 1 );
+}
+
+TEST_CASE("log_file_search_cache") {
+    qapp();
+
+    auto file = makeLogFile(simpleLog);
+    waitParsingAndIndexing(file);
+
+    file.search("SUB", false, true, false, false);
+    waitFor([&] { return file.isState(gui::sm::CompleteState); });
+    REQUIRE( file.searchLogTableModel()->rowCount({}) == 3 );
+    auto subHist = file.searchHist();
+
+    file.search("CORE", false, true, false, false);
+    waitFor([&] { return file.isState(gui::sm::CompleteState); });
+    REQUIRE( file.searchLogTableModel()->rowCount({}) == 3 );
+    REQUIRE( file.searchHist() != subHist );
+
+    // the repeated query is served from the cache
+
+    file.search("SUB", false, true, false, false);
+    waitFor([&] { return file.isState(gui::sm::CompleteState); });
+    REQUIRE( file.searchLogTableModel()->rowCount({}) == 3 );
+    REQUIRE( file.searchLogTableModel()->lineOffset(2) == 5 );
+    REQUIRE( file.searchHist() == subHist );
+
+    // the same query with a different filter is searched again
+
+    file.setColumnFilter(2, {"INFO"});
+    file.search("SUB", false, true, false, false);
+    waitFor([&] { return file.isState(gui::sm::CompleteState); });
+    REQUIRE( file.searchLogTableModel()->rowCount({}) == 2 );
+    REQUIRE( file.searchHist() != subHist );
+}
+
+TEST_CASE("log_file_search_column") {
+    qapp();
+
+    auto file = makeLogFile(simpleLog);
+    waitParsingAndIndexing(file);
+
+    file.search("O", false, true, false, false, 2);
+    waitFor([&] { return file.isState(gui::sm::CompleteState); });
+    auto searchModel = file.searchLogTableModel();
+    REQUIRE( searchModel->rowCount({}) == 3 );
+    REQUIRE( searchModel->lineOffset(0) == 0 );
+    REQUIRE( searchModel->lineOffset(1) == 2 );
+    REQUIRE( searchModel->lineOffset(2) == 4 );
+
+    // the same text in all columns is a different search
+
+    file.search("O", false, true, false, false);
+    waitFor([&] { return file.isState(gui::sm::CompleteState); });
+    REQUIRE( file.searchLogTableModel()->rowCount({}) == 5 );
+}
+
+TEST_CASE("log_file_find_next_previous") {
+    qapp();
+
+    auto file = makeLogFile(simpleLog);
+    waitParsingAndIndexing(file);
+
+    auto model = file.logTableModel();
+    auto selectedRow = [&] {
+        auto selection = model->getRowSelection();
+        return selection ? selection->first : -1;
+    };
+
+    file.find("SUB", false, true, false, false, false);
+    waitFor([&] { return selectedRow() == 1; });
+    file.find("SUB", false, true, false, false, false);
+    waitFor([&] { return selectedRow() == 3; });
+    file.find("SUB", false, true, false, false, true);
+    waitFor([&] { return selectedRow() == 1; });
+
+    // the row is in the filtered view, INFO lines are 0, 1 and 3
+    file.setColumnFilter(2, {"INFO"});
+    file.find("SUB", false, true, false, false, false);
+    waitFor([&] { return selectedRow() == 2; });
+}
+
 TEST_CASE("log_file_search_message_only") {
     qapp();
 
@@ -571,6 +731,7 @@ TEST_CASE("reload_from_complete_state_adapt_filters") {
     file.reload(std::make_shared<std::stringstream>(simpleLogAlt));
 
     waitFor([&] { return file.isState(gui::sm::CompleteState); });
+    waitFor([&] { return !file.isFiltering(); });
 
     REQUIRE( file.getColumnFilter(2) == std::set<std::string>{"INFO"} );
 
@@ -608,6 +769,7 @@ TEST_CASE("log_file_clear_filters") {
     waitParsingAndIndexing(file);
 
     file.setColumnFilter(2, {"INFO", "ERR"});
+    waitFor([&] { return !file.isFiltering(); });
 
     auto model = file.logTableModel();
     REQUIRE(model->headerData(2, Qt::Horizontal, (int)HeaderDataRole::IsFilterActive).toBool() == true);
@@ -804,3 +966,77 @@ TEST_CASE("log_file_filter_exclude_include_clear") {
         REQUIRE( !model->getRowSelection().has_value() );
     }
 }
+
+TEST_CASE("log_file_cached_filter_keeps_selected_line") {
+    qapp();
+
+    auto file = makeLogFile(simpleLog);
+    waitParsingAndIndexing(file);
+    auto model = file.logTableModel();
+
+    file.includeOnlyValue(2, "ERR");
+    waitFor([&] { return !file.isFiltering(); });
+    REQUIRE( model->rowCount({}) == 1 );
+    file.clearFilters();
+    REQUIRE( model->rowCount({}) == 6 );
+
+    // the selected row is neither among the prefetched rows nor among those of the cached filter
+    model->setSelection(4, 0, 0);
+    model->prefetchRows(0, 2);
+    file.includeOnlyValue(2, "ERR");
+    REQUIRE( !file.isFiltering() );
+    REQUIRE( model->rowCount({}) == 1 );
+    auto selection = model->getRowSelection();
+    REQUIRE( selection.has_value() );
+    REQUIRE( selection->first == 0 );
+    REQUIRE( model->lineOffset(0) == 4 );
+}
+
+TEST_CASE("log_file_clear_filters_keeps_selected_line") {
+    qapp();
+
+    auto file = makeLogFile(simpleLog);
+    waitParsingAndIndexing(file);
+    auto model = file.logTableModel();
+
+    file.setColumnFilter(2, {"WARN", "ERR"});
+    waitFor([&] { return !file.isFiltering(); });
+    REQUIRE( model->rowCount({}) == 3 );
+
+    // row 1 is line 4 while filtered and line 1 once the filters are gone
+    model->setSelection(1, 0, 0);
+    file.clearFilters();
+    REQUIRE( model->rowCount({}) == 6 );
+    auto selection = model->getRowSelection();
+    REQUIRE( selection.has_value() );
+    REQUIRE( selection->first == 4 );
+}
+
+TEST_CASE("log_file_include_value_range") {
+    qapp();
+
+    auto file = makeLogFile(simpleLog);
+    waitParsingAndIndexing(file);
+    auto model = file.logTableModel();
+
+    // the levels are ordered ERR, INFO, WARN
+    file.includeValueRange(2, "INFO", {});
+    waitFor([&] { return !file.isFiltering(); });
+    REQUIRE( file.getColumnFilter(2) == std::set<std::string>{"INFO", "WARN"} );
+    REQUIRE( model->rowCount({}) == 5 );
+
+    // the upper bound narrows the lower one instead of replacing it
+    file.includeValueRange(2, {}, "INFO");
+    waitFor([&] { return !file.isFiltering(); });
+    REQUIRE( file.getColumnFilter(2) == std::set<std::string>{"INFO"} );
+    REQUIRE( model->rowCount({}) == 3 );
+
+    // an excluded value stays excluded
+    file.clearFilters();
+    file.excludeValue(2, "WARN");
+    waitFor([&] { return !file.isFiltering(); });
+    file.includeValueRange(2, "ERR", "WARN");
+    waitFor([&] { return !file.isFiltering(); });
+    REQUIRE( file.getColumnFilter(2) == std::set<std::string>{"ERR", "INFO"} );
+    REQUIRE( model->rowCount({}) == 4 );
+}
@@ -1,15 +1,45 @@
 #include <catch2/catch.hpp>
 
 #include "TestLineParser.h"
+#include "seer/AppendOnlyLineMap.h"
 #include "seer/ILineParser.h"
 #include "seer/FileParser.h"
 #include "seer/Index.h"
 #include "seer/LineParserRepository.h"
 #include "seer/StringLiterals.h"
+#include <fmt/format.h>
 #include <sstream>
 
 using namespace seer;
 
+namespace {
+
+// a log read from a string, parsed and indexed on the calling thread
+struct IndexedLog {
+    std::stringstream stream;
+    std::shared_ptr<ILineParser> lineParser;
+    FileParser fileParser;
+    Index index;
+
+    explicit IndexedLog(const std::string& log,
+                        std::shared_ptr<ILineParser> parser = createTestParser())
+        : stream(log), lineParser(std::move(parser)), fileParser(&stream, lineParser.get()) {
+        fileParser.index();
+        index.index(&fileParser, lineParser.get(), 0, []{ return false; }, [](auto, auto){});
+    }
+};
+
+// the line of every row the index shows
+std::vector<uint64_t> indexLines(Index& index) {
+    std::vector<uint64_t> lines;
+    for (uint64_t i = 0; i < index.getLineCount(); ++i) {
+        lines.push_back(index.mapIndex(i));
+    }
+    return lines;
+}
+
+} // namespace
+
 TEST_CASE("get_parser_name") {
     std::stringstream ss(simpleLog);
     TestLineParserRepository repository;
@@ -63,6 +93,8 @@ TEST_CASE("simple_index") {
     REQUIRE( index.getLineCount() == 6 );
     REQUIRE( index.mapIndex(0) == 0 );
     REQUIRE( index.mapIndex(5) == 5 );
+    REQUIRE( index.findIndex(5) == 5 );
+    REQUIRE( !index.findIndex(6) );
 
     std::vector<ColumnFilter> filters;
     filters = {{1, {"INFO"}}};
@@ -143,6 +175,116 @@ TEST_CASE("get_values") {
     REQUIRE( values[1].checked == true );
 }
 
+TEST_CASE("get_values_many_values") {
+    std::string log;
+    const char* levels[] = {"INFO", "WARN", "ERR"};
+    for (int i = 0; i < 20000; ++i) {
+        log += fmt::format("{} {} C{} message {}\n", i, levels[i % 3], i % 5000, i);
+    }
+    IndexedLog indexed(log);
+    auto& index = indexed.index;
+
+    auto values = index.getValues(2);
+    REQUIRE( values.size() == 5000 );
+    REQUIRE( std::ranges::all_of(values, [](auto& info) { return info.count == 4 && info.checked; }) );
+    REQUIRE( index.getValues(2) == values );
+
+    // C{n} is on the lines n, n + 5000, n + 10000 and n + 15000, one in three of them WARN
+    index.filter({{1, {"WARN"}}, {2, {"C1", "C2"}}});
+    values = index.getValues(2);
+    REQUIRE( values.size() == 5000 );
+    for (auto& info : values) {
+        auto n = std::stoi(info.value.substr(1));
+        uint64_t expected = 0;
+        for (auto line = n; line < 20000; line += 5000) {
+            expected += line % 3 == 1;
+        }
+        REQUIRE( info.count == expected );
+        REQUIRE( info.checked == (n == 1 || n == 2) );
+    }
+
+    values = index.getValues(1);
+    REQUIRE( values[0].value == "ERR" );
+    REQUIRE( values[0].count == 3 );
+    REQUIRE( values[1].count == 2 );
+    REQUIRE( values[2].count == 3 );
+    REQUIRE( !values[0].checked );
+    REQUIRE( values[2].checked );
+}
+
+TEST_CASE("filter_stop") {
+    IndexedLog indexed(simpleLog);
+    auto& index = indexed.index;
+    REQUIRE( index.getValueNames(1) == std::vector<std::string>{"ERR", "INFO", "WARN"} );
+
+    // a stopped copy is discarded, the original index is left as it was
+    Index stopped = index;
+    REQUIRE( !stopped.filter({{1, {"INFO"}}}, [] { return true; }) );
+    REQUIRE( index.getLineCount() == 6 );
+
+    Index filtered = index;
+    REQUIRE( filtered.filter({{1, {"INFO"}}}, [] { return false; }) );
+    REQUIRE( filtered.getLineCount() == 3 );
+    REQUIRE( index.getLineCount() == 6 );
+}
+
+TEST_CASE("index_copy_filters_independently") {
+    IndexedLog indexed(simpleLog);
+    auto& index = indexed.index;
+    index.filter({{1, {"INFO"}}});
+
+    // the copy shares the columns, its filters leave those of the original alone
+    Index copy = index;
+    copy.filter({{1, {"WARN", "MISSING"}}});
+    REQUIRE( copy.getLineCount() == 2 );
+    REQUIRE( copy.mapIndex(1) == 5 );
+    REQUIRE( index.getLineCount() == 3 );
+    REQUIRE( index.getValues(2)[0].count == 1 );
+    REQUIRE( copy.getValueNames(1) == std::vector<std::string>{"ERR", "INFO", "WARN"} );
+}
+
+TEST_CASE("filter_snapshot") {
+    IndexedLog indexed(simpleLog);
+    auto& index = indexed.index;
+    auto unfiltered = index.filterSnapshot();
+    REQUIRE( unfiltered->sizeInBytes() == 0 );
+
+    index.filter({{1, {"INFO"}}});
+    REQUIRE( index.getValues(2)[0].count == 1 );
+    auto info = index.filterSnapshot();
+    REQUIRE( info->sizeInBytes() > 0 );
+
+    // the value names are weighed with the bitmaps, the filter and the selection both hold them
+    std::string missing(1000, 'x');
+    index.filter({{1, {"INFO", missing}}});
+    REQUIRE( index.filterSnapshot()->sizeInBytes() > info->sizeInBytes() + 2 * missing.size() );
+
+    index.filter({{1, {"WARN", "ERR"}}, {2, {"CORE"}}});
+    REQUIRE( index.getLineCount() == 2 );
+
+    index.restoreFilter(*info);
+    REQUIRE( index.getLineCount() == 3 );
+    REQUIRE( index.mapIndex(2) == 3 );
+    REQUIRE( index.findIndex(3) == 2 );
+    REQUIRE( !index.findIndex(2) );
+    std::vector<uint64_t> lines(3);
+    index.mapRange(0, lines);
+    REQUIRE( lines == std::vector<uint64_t>{0, 1, 3} );
+    REQUIRE( index.getValues(1)[1].checked );
+    REQUIRE( !index.getValues(1)[0].checked );
+    REQUIRE( index.getValues(2)[0].count == 1 );
+
+    index.restoreFilter(*unfiltered);
+    REQUIRE( index.getLineCount() == 6 );
+    REQUIRE( index.mapIndex(5) == 5 );
+
+    // the snapshot is unaffected by filtering the index again
+    index.filter({{1, {"ERR"}}});
+    REQUIRE( index.getLineCount() == 1 );
+    index.restoreFilter(*info);
+    REQUIRE( index.getLineCount() == 3 );
+}
+
 TEST_CASE("get_values_three_columns") {
     std::stringstream ss(threeColumnLog);
     auto lineParser = createThreeColumnTestParser();
@@ -652,6 +794,605 @@ TEST_CASE("search_hist_simple") {
     REQUIRE( hist2.get(2, 3) == 1 );
 }
 
+TEST_CASE("search_parallel") {
+    std::string log;
+    const char* levels[] = {"INFO", "WARN", "ERR"};
+    for (int i = 0; i < 50000; ++i) {
+        log += fmt::format("{} {} CORE message {}\n", i, levels[i % 3], i);
+    }
+    IndexedLog indexed(log);
+    auto& fileParser = indexed.fileParser;
+    auto& index = indexed.index;
+
+    auto search = [&](auto& indexCopy, Hist& hist, unsigned maxThreads) {
+        uint64_t lastProgress = 0;
+        indexCopy.search(
+            &fileParser,
+            "7",
+            false,
+            true,
+            false,
+            true,
+            hist,
+            [] { return false; },
+            [&](auto i, auto) {
+                REQUIRE( i >= lastProgress );
+                lastProgress = i;
+            },
+            maxThreads);
+        return indexLines(indexCopy);
+    };
+
+    auto expected = [&](int step) {
+        std::vector<uint64_t> lines;
+        for (int i = 0; i < 50000; i += step) {
+            if (std::to_string(i).find('7') != std::string::npos) {
+                lines.push_back(i);
+            }
+        }
+        return lines;
+    };
+
+    Hist sequentialHist(100), parallelHist(100);
+    auto indexCopy = index;
+    REQUIRE( search(indexCopy, sequentialHist, 1) == expected(1) );
+    indexCopy = index;
+    REQUIRE( search(indexCopy, parallelHist, 4) == expected(1) );
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE( sequentialHist.get(i, 100) == parallelHist.get(i, 100) );
+    }
+
+    std::vector<ColumnFilter> filters;
+    filters = {{1, {"INFO"}}};
+    indexCopy = index;
+    indexCopy.filter(filters);
+    Hist filteredHist(100);
+    REQUIRE( search(indexCopy, filteredHist, 4) == expected(3) );
+
+    indexCopy = index;
+    Hist stoppedHist(100);
+    auto result = indexCopy.search(
+        &fileParser, "7", false, true, false, false, stoppedHist, [] { return true; }, {}, 4);
+    REQUIRE( !result );
+}
+
+TEST_CASE("search_parallel_lines") {
+    std::string log;
+    const char* levels[] = {"INFO", "WARN", "ERR"};
+    for (int i = 0; i < 50000; ++i) {
+        log += fmt::format("{} {} CORE message {}\n", i, levels[i % 3], i);
+    }
+    IndexedLog indexed(log);
+    auto& fileParser = indexed.fileParser;
+    auto& index = indexed.index;
+
+    // caseless and regex queries are matched line by line on the worker pool
+    auto search = [&](bool regex, bool caseSensitive, unsigned maxThreads, Hist& hist) {
+        auto indexCopy = index;
+        indexCopy.search(
+            &fileParser, "7", regex, caseSensitive, false, true, hist, [] { return false; }, {},
+            maxThreads);
+        return indexLines(indexCopy);
+    };
+
+    for (auto [regex, caseSensitive] : {std::pair(false, false), std::pair(true, true)}) {
+        Hist sequentialHist(100), parallelHist(100);
+        auto lines = search(regex, caseSensitive, 1, sequentialHist);
+        REQUIRE( lines.size() == 17195 );
+        REQUIRE( search(regex, caseSensitive, 4, parallelHist) == lines );
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE( sequentialHist.get(i, 100) == parallelHist.get(i, 100) );
+        }
+    }
+}
+
+TEST_CASE("search_blocks") {
+    std::string log;
+    const char* levels[] = {"INFO", "WARN", "ERR"};
+    for (int i = 0; i < 50000; ++i) {
+        if (i) {
+            log += "\n";
+        }
+        log += fmt::format("{} {} CORE message {}", i, levels[i % 3], i);
+    }
+    IndexedLog indexed(log);
+    auto& fileParser = indexed.fileParser;
+    auto& index = indexed.index;
+
+    auto search = [&](auto& indexCopy, std::string text, bool regex, bool messageOnly, Hist& hist) {
+        indexCopy.search(&fileParser, text, regex, true, false, messageOnly, hist);
+        return indexLines(indexCopy);
+    };
+
+    auto compare = [&](std::string text, bool messageOnly, std::vector<ColumnFilter> filters) {
+        Hist blockHist(100), regexHist(100);
+        auto blockIndex = index;
+        auto regexIndex = index;
+        blockIndex.filter(filters);
+        regexIndex.filter(filters);
+        auto lines = search(blockIndex, text, false, messageOnly, blockHist);
+        REQUIRE( lines == search(regexIndex, text, true, messageOnly, regexHist) );
+        for (int i = 0; i < 100; ++i) {
+            REQUIRE( blockHist.get(i, 100) == regexHist.get(i, 100) );
+        }
+        return lines.size();
+    };
+
+    REQUIRE( compare("77", false, {}) == 1400 );
+    REQUIRE( compare("49999", false, {}) == 1 );
+    REQUIRE( compare("WARN", false, {}) == 16667 );
+    REQUIRE( compare("WARN", true, {}) == 0 );
+    REQUIRE( compare("message 4", true, {{1, {"INFO"}}}) == 3702 );
+    REQUIRE( compare("0 E", false, {{1, {"INFO", "ERR"}}}) == 1666 );
+}
+
+TEST_CASE("value_order") {
+    ValueOrder numeric{ValueOrder::Kind::Numeric, {}};
+    REQUIRE( numeric.less("9", "10") );
+    REQUIRE( numeric.less("-1.5", "0") );
+    REQUIRE( numeric.less("500", "abc") );
+    REQUIRE( !numeric.less("abc", "500") );
+    REQUIRE( numeric.less("1", "1.0") );
+
+    ValueOrder levels{ValueOrder::Kind::Explicit, {"INFO", "WARN", "ERR"}};
+    REQUIRE( levels.less("WARN", "ERR") );
+    REQUIRE( levels.less("ERR", "DEBUG") );
+    REQUIRE( levels.less("DEBUG", "TRACE") );
+    REQUIRE( !levels.less("ERR", "WARN") );
+
+    ValueOrder lexicographic;
+    REQUIRE( lexicographic.less("10", "9") );
+}
+
+TEST_CASE("filter_value_range") {
+    auto config = testConfig;
+    config.replace(config.find(R"("indexed": false)"), 16, R"("indexed": true)");
+    auto insertAfter = [&](std::string anchor, std::string text) {
+        config.insert(config.find(anchor) + anchor.size(), text);
+    };
+    insertAfter(R"("group": 1,)", R"("order": "numeric",)");
+    insertAfter(R"("group": 2,)", R"("order": ["INFO", "WARN", "ERR"],)");
+    auto lineParser = std::make_shared<seer::RegexLineParser>("ordered");
+    lineParser->load(config);
+
+    IndexedLog indexed(simpleLog + "9 INFO CORE message 7\n100 ERR SUB message 8\n", lineParser);
+    auto& index = indexed.index;
+    REQUIRE( index.getValueNames(0) ==
+             std::vector<std::string>{"9", "10", "15", "17", "20", "30", "40", "100"} );
+    REQUIRE( index.getValueNames(1) == std::vector<std::string>{"INFO", "WARN", "ERR"} );
+    REQUIRE( index.getValueNames(2) == std::vector<std::string>{"CORE", "SUB"} );
+    REQUIRE( index.getValues(1)[0].value == "INFO" );
+
+    REQUIRE( index.valuesInRange(1, "WARN", {}) == std::set<std::string>{"WARN", "ERR"} );
+    REQUIRE( index.valuesInRange(1, {}, "INFO") == std::set<std::string>{"INFO"} );
+    REQUIRE( index.valuesInRange(0, "12", "35") == std::set<std::string>{"15", "17", "20", "30"} );
+    REQUIRE( index.valuesInRange(0, "50", "20").empty() );
+
+    index.filter({{1, index.valuesInRange(1, "WARN", {})}});
+    REQUIRE( index.getLineCount() == 4 );
+    REQUIRE( index.mapIndex(3) == 7 );
+    index.filter({{0, index.valuesInRange(0, {}, "15")}, {1, {"INFO"}}});
+    REQUIRE( index.getLineCount() == 3 );
+
+    auto invalid = testConfig;
+    invalid.insert(invalid.find(R"("group": 2,)"), R"("order": "alphabetic",)");
+    REQUIRE_THROWS_AS(seer::RegexLineParser("").load(invalid), seer::OptionInconsistencyException);
+}
+
+TEST_CASE("search_trigram_index") {
+    std::string log;
+    const char* levels[] = {"INFO", "WARN", "ERR"};
+    for (int i = 0; i < 20000; ++i) {
+        log += fmt::format("{} {} CORE message {}\n", i, levels[i % 3], i);
+    }
+    std::stringstream ss(log);
+    auto lineParser = createTestParser();
+
+    auto config = testConfig;
+    config.insert(config.find('{') + 1, R"("trigramIndex": true,)");
+    seer::RegexLineParser trigramParser{"trigram"};
+    trigramParser.load(config);
+    REQUIRE( trigramParser.trigramIndex() );
+    REQUIRE( !lineParser->trigramIndex() );
+
+    FileParser fileParser(&ss, lineParser.get());
+    fileParser.index();
+
+    Index index, trigramIndex;
+    index.index(&fileParser, lineParser.get(), 0, []{ return false; }, [](auto, auto){});
+    trigramIndex.index(&fileParser, &trigramParser, 0, []{ return false; }, [](auto, auto){});
+
+    auto search = [&](Index indexCopy,
+                      std::string text,
+                      bool regex,
+                      bool caseSensitive,
+                      bool messageOnly,
+                      std::vector<ColumnFilter> filters) {
+        Hist hist(100);
+        indexCopy.filter(filters);
+        indexCopy.search(&fileParser, text, regex, caseSensitive, false, messageOnly, hist);
+        auto lines = indexLines(indexCopy);
+        std::vector<int> bins;
+        for (int i = 0; i < 100; ++i) {
+            bins.push_back(hist.get(i, 100));
+        }
+        return std::tuple(lines, bins);
+    };
+
+    auto compare = [&](std::string text,
+                       bool caseSensitive,
+                       bool messageOnly,
+                       std::vector<ColumnFilter> filters) {
+        auto expected = search(index, text, true, caseSensitive, messageOnly, filters);
+        auto actual = search(trigramIndex, text, false, caseSensitive, messageOnly, filters);
+        REQUIRE( actual == expected );
+        return std::get<0>(actual).size();
+    };
+
+    REQUIRE( compare("777", true, false, {}) == 38 );
+    REQUIRE( compare("warn c", true, false, {}) == 0 );
+    REQUIRE( compare("warn c", false, false, {}) == 6667 );
+    REQUIRE( compare("Core", false, true, {}) == 0 );
+    REQUIRE( compare("message 1", true, true, {{1, {"INFO"}}}) == 3702 );
+    REQUIRE( compare("zzz", true, false, {}) == 0 );
+    REQUIRE( compare("7", true, false, {}) == 6878 );
+}
+
+TEST_CASE("search_trigram_index_single_column") {
+    std::string log;
+    for (int i = 0; i < 1000; ++i) {
+        log += fmt::format("message {}\n", i);
+    }
+    auto lineParser = std::make_shared<seer::RegexLineParser>("trigram");
+    lineParser->load(R"_(
+        {
+            "description": "single column",
+            "regex": "(.*)",
+            "trigramIndex": true,
+            "columns": [{"name": "Message", "group": 1}]
+        }
+    )_");
+    REQUIRE( lineParser->getColumnFormats().size() == 1 );
+
+    // the lines are only parsed, yet their trigrams are indexed
+    IndexedLog indexed(log, lineParser);
+    Hist hist(100);
+    auto index = indexed.index;
+    REQUIRE( index.search(&indexed.fileParser, "age 77", false, true, false, false, hist) );
+    REQUIRE( indexLines(index) == std::vector<uint64_t>{77, 770, 771, 772, 773, 774, 775, 776,
+                                                         777, 778, 779} );
+}
+
+TEST_CASE("search_results_visible_while_searching") {
+    IndexedLog indexed(simpleLog);
+    auto& fileParser = indexed.fileParser;
+    auto& index = indexed.index;
+
+    seer::Hist hist(6);
+
+    std::vector<uint64_t> counts;
+    std::vector<uint64_t> lastLines;
+    int histTotal = 0;
+
+    auto indexCopy = index;
+    indexCopy.search(
+        &fileParser,
+        "sub",
+        false,
+        false,
+        false,
+        false,
+        hist,
+        [] { return false; },
+        [&](auto, auto) {
+            auto count = indexCopy.getLineCount();
+            counts.push_back(count);
+            if (count) {
+                lastLines.push_back(indexCopy.mapIndex(count - 1));
+            }
+            histTotal = 0;
+            for (int i = 0; i < 6; ++i) {
+                histTotal += hist.get(i, 6);
+            }
+        });
+    REQUIRE( counts == std::vector<uint64_t>{0, 1, 1, 2, 2, 3} );
+    REQUIRE( lastLines == std::vector<uint64_t>{1, 1, 3, 3, 5} );
+    REQUIRE( histTotal == 3 );
+    REQUIRE( indexCopy.getLineCount() == 3 );
+}
+
+TEST_CASE("search_restore_results") {
+    IndexedLog indexed(simpleLog);
+    auto& fileParser = indexed.fileParser;
+    auto& index = indexed.index;
+
+    seer::Hist hist(1);
+    auto searched = index;
+    searched.search(&fileParser, "CORE", false, true, false, false, hist);
+    REQUIRE( searched.getLineCount() == 3 );
+
+    auto restored = index;
+    restored.restoreSearchResults(searched.searchResults());
+    REQUIRE( restored.getLineCount() == 3 );
+    REQUIRE( restored.mapIndex(0) == 0 );
+    REQUIRE( restored.mapIndex(1) == 2 );
+    REQUIRE( restored.mapIndex(2) == 4 );
+    REQUIRE( restored.searchResults() == searched.searchResults() );
+}
+
+TEST_CASE("search_column") {
+    IndexedLog indexed(simpleLog);
+    auto& fileParser = indexed.fileParser;
+    auto& index = indexed.index;
+
+
+    seer::Hist hist(6);
+    auto indexCopy = index;
+    REQUIRE( indexCopy.searchColumn(&fileParser, 2, "SUB", false, true, false, hist) );
+    REQUIRE( indexLines(indexCopy) == std::vector<uint64_t>{1, 3, 5} );
+    REQUIRE( hist.get(1, 6) == 1 );
+    REQUIRE( hist.get(2, 6) == 0 );
+
+    // the message also contains "message", but only the column is searched
+    indexCopy = index;
+    REQUIRE( indexCopy.searchColumn(&fileParser, 1, "ERR|warn", true, false, false, hist) );
+    REQUIRE( indexLines(indexCopy) == std::vector<uint64_t>{2, 4, 5} );
+
+    indexCopy = index;
+    REQUIRE( indexCopy.searchColumn(&fileParser, 2, "message", false, false, false, hist) );
+    REQUIRE( indexCopy.getLineCount() == 0 );
+
+    // INFO lines are 0, 1 and 3
+    std::vector<ColumnFilter> filters = {{1, {"INFO"}}};
+    indexCopy = index;
+    indexCopy.filter(filters);
+    seer::Hist filteredHist(3);
+    REQUIRE( indexCopy.searchColumn(&fileParser, 2, "ub", false, false, false, filteredHist) );
+    REQUIRE( indexLines(indexCopy) == std::vector<uint64_t>{1, 3} );
+    REQUIRE( filteredHist.get(0, 3) == 0 );
+    REQUIRE( filteredHist.get(1, 3) == 1 );
+    REQUIRE( filteredHist.get(2, 3) == 1 );
+}
+
+TEST_CASE("search_many") {
+    IndexedLog indexed(simpleLog);
+    auto& fileParser = indexed.fileParser;
+    auto& index = indexed.index;
+
+    auto found = [](const QueryResult& result) {
+        std::vector<uint64_t> lines(result.lines->size());
+        result.lines->getRange(0, lines);
+        return lines;
+    };
+
+    std::vector<SearchQuery> queries = {
+        {"SUB", false, true, false, false},
+        {"warn", false, false, false, false},
+        {"message [15]", true, false, false, false},
+        {"E 4", false, false, false, true},
+        {"INFO", false, true, false, true},
+    };
+    std::vector<std::unique_ptr<Hist>> hists;
+    std::vector<Hist*> histPointers;
+    for (auto i = 0u; i < queries.size(); ++i) {
+        hists.push_back(std::make_unique<Hist>(6));
+        histPointers.push_back(hists.back().get());
+    }
+
+    std::vector<QueryResult> results;
+    int progressCalls = 0;
+    REQUIRE( index.searchMany(&fileParser,
+                              queries,
+                              results,
+                              histPointers,
+                              [] { return false; },
+                              [&](auto, auto) { progressCalls++; }) );
+    REQUIRE( progressCalls == 6 );
+    REQUIRE( results.size() == 5 );
+    REQUIRE( found(results[0]) == std::vector<uint64_t>{1, 3, 5} );
+    REQUIRE( found(results[1]) == std::vector<uint64_t>{2, 5} );
+    REQUIRE( found(results[2]) == std::vector<uint64_t>{0, 4} );
+    REQUIRE( found(results[3]) == std::vector<uint64_t>{3} );
+    REQUIRE( results[4].lines->size() == 0 );
+    REQUIRE( hists[0]->get(3, 6) == 1 );
+    REQUIRE( hists[1]->get(2, 6) == 1 );
+
+    // the same queries searched one by one
+    for (auto i = 0u; i < queries.size(); ++i) {
+        auto& query = queries[i];
+        Hist hist(6);
+        auto single = index;
+        single.search(&fileParser,
+                      query.text,
+                      query.regex,
+                      query.caseSensitive,
+                      query.unicodeAware,
+                      query.messageOnly,
+                      hist);
+        REQUIRE( indexLines(single) == found(results[i]) );
+    }
+
+    // INFO lines are 0, 1 and 3
+    std::vector<ColumnFilter> filters = {{1, {"INFO"}}};
+    auto filtered = index;
+    filtered.filter(filters);
+    REQUIRE( filtered.searchMany(&fileParser, queries, results, histPointers) );
+    REQUIRE( found(results[0]) == std::vector<uint64_t>{1, 3} );
+    REQUIRE( results[1].lines->size() == 0 );
+    REQUIRE( found(results[2]) == std::vector<uint64_t>{0} );
+    REQUIRE( found(results[3]) == std::vector<uint64_t>{3} );
+}
+
+TEST_CASE("find_next_previous") {
+    IndexedLog indexed(simpleLog);
+    auto& fileParser = indexed.fileParser;
+    auto& index = indexed.index;
+
+    auto find = [&](Index& index, std::optional<uint64_t> row, bool backward, std::string text) {
+        return index.find(&fileParser, row, backward, text, false, true, false, false);
+    };
+
+    REQUIRE( find(index, {}, false, "SUB") == 1 );
+    REQUIRE( find(index, 1, false, "SUB") == 3 );
+    REQUIRE( find(index, 5, false, "SUB") == std::nullopt );
+    REQUIRE( find(index, 3, true, "SUB") == 1 );
+    REQUIRE( find(index, {}, true, "SUB") == 5 );
+    REQUIRE( find(index, 1, true, "SUB") == std::nullopt );
+    REQUIRE( find(index, {}, false, "none") == std::nullopt );
+
+    // INFO lines are 0, 1 and 3, the row is in the filtered view
+    std::vector<ColumnFilter> filters = {{1, {"INFO"}}};
+    index.filter(filters);
+    REQUIRE( find(index, 1, false, "message") == 3 );
+    REQUIRE( find(index, 2, false, "message") == std::nullopt );
+    REQUIRE( find(index, 2, true, "message") == 1 );
+    REQUIRE( find(index, {}, true, "message") == 3 );
+    REQUIRE( find(index, 0, false, "SUB") == 1 );
+}
+
+TEST_CASE("find_next_previous_long_file") {
+    std::string log;
+    for (auto i = 0; i < 20000; ++i) {
+        auto message = i == 15000 || i == 17000 ? "needle" : "message";
+        log += fmt::format("{} {} CORE {} {}\n", i, i % 2 ? "INFO" : "WARN", message, i);
+    }
+    IndexedLog indexed(log);
+    auto& fileParser = indexed.fileParser;
+    auto& index = indexed.index;
+
+    auto find = [&](std::optional<uint64_t> row, bool backward) {
+        return index.find(&fileParser, row, backward, "needle", false, true, false, false);
+    };
+
+    REQUIRE( find(0, false) == 15000 );
+    REQUIRE( find(15000, false) == 17000 );
+    REQUIRE( find(17000, false) == std::nullopt );
+    REQUIRE( find({}, true) == 17000 );
+    REQUIRE( find(15000, true) == std::nullopt );
+
+    // backward, the windows of rows are matched on one or several threads and the last match of
+    // a window is the previous one
+    for (auto maxThreads : {1u, 4u}) {
+        auto findPrevious = [&](std::optional<uint64_t> row) {
+            return index.find(
+                &fileParser, row, true, "needle", false, true, false, false, [] { return false; },
+                maxThreads);
+        };
+        REQUIRE( findPrevious({}) == 17000 );
+        REQUIRE( findPrevious(17000) == 15000 );
+        REQUIRE( findPrevious(15001) == 15000 );
+        REQUIRE( findPrevious(15000) == std::nullopt );
+    }
+
+    bool stop = false;
+    REQUIRE( index.find(&fileParser, {}, true, "needle", false, true, false, false, [&] {
+        return stop = true;
+    }) == std::nullopt );
+    REQUIRE( stop );
+
+    stop = false;
+    REQUIRE( index.find(&fileParser, {}, false, "needle", false, true, false, false, [&] {
+        return stop = true;
+    }) == std::nullopt );
+    REQUIRE( stop );
+
+    // the even lines are WARN, rows 7500 and 8500
+    std::vector<ColumnFilter> filters = {{1, {"WARN"}}};
+    index.filter(filters);
+    REQUIRE( find(0, false) == 15000 );
+    REQUIRE( find(7500, false) == 17000 );
+    REQUIRE( find(8500, true) == 15000 );
+}
+
+TEST_CASE("search_regex_limit") {
+    std::string aaa(40, 'a');
+    auto log = fmt::format("10 INFO CORE {}!\n"
+                           "15 INFO SUB {}\n"
+                           "17 WARN CORE {}!\n",
+                           aaa, aaa, aaa);
+    IndexedLog indexed(log);
+    auto& fileParser = indexed.fileParser;
+    auto& index = indexed.index;
+
+    seer::Hist hist(3);
+    auto indexCopy = index;
+    indexCopy.search(&fileParser, "(a+)+$", true, true, false, false, hist);
+    REQUIRE( indexCopy.getLineCount() == 1 );
+    REQUIRE( indexCopy.mapIndex(0) == 1 );
+    REQUIRE( indexCopy.regexLimitHits() == 2 );
+
+    indexCopy = index;
+    indexCopy.search(&fileParser, "a+$", true, true, false, false, hist);
+    REQUIRE( indexCopy.getLineCount() == 1 );
+    REQUIRE( indexCopy.regexLimitHits() == 0 );
+
+    // every query of a combined search counts its own hits
+    std::vector<SearchQuery> queries = {
+        {"(a+)+$", true, true, false, false},
+        {"a+$", true, true, false, false},
+        {"WARN", false, true, false, false},
+    };
+    Hist hists[3] = {Hist(3), Hist(3), Hist(3)};
+    std::vector<QueryResult> results;
+    REQUIRE( index.searchMany(&fileParser, queries, results, {&hists[0], &hists[1], &hists[2]}) );
+    REQUIRE( results[0].lines->size() == 1 );
+    REQUIRE( results[0].regexLimitHits == 2 );
+    REQUIRE( results[1].regexLimitHits == 0 );
+    REQUIRE( results[2].lines->size() == 1 );
+    REQUIRE( results[2].regexLimitHits == 0 );
+
+    indexCopy = index;
+    indexCopy.restoreSearchResults(results[0].lines->bitset(), results[0].regexLimitHits);
+    REQUIRE( indexCopy.mapIndex(0) == 1 );
+    REQUIRE( indexCopy.regexLimitHits() == 2 );
+}
+
+TEST_CASE("search_within_results") {
+    IndexedLog indexed(simpleLog);
+    auto& fileParser = indexed.fileParser;
+    auto& index = indexed.index;
+
+    std::vector<ColumnFilter> filters;
+    filters = {{1, {"INFO", "WARN"}}};
+    index.filter(filters);
+
+    /*
+        10 INFO CORE message 1
+      + 15 INFO SUB message 2
+        17 WARN CORE message 3
+      + 20 INFO SUB message 4
+      + 40 WARN SUB message 6
+    */
+
+    Hist hist(5);
+    auto previous = index;
+    previous.search(&fileParser, "SUB", false, true, false, false, hist);
+    auto results = previous.searchResults();
+    REQUIRE( results.numberOfOnes() == 3 );
+
+    std::vector<uint64_t> progress;
+    Hist refinedHist(5);
+    auto refined = index;
+    refined.search(&fileParser,
+                   "[46]",
+                   true,
+                   true,
+                   false,
+                   true,
+                   refinedHist,
+                   [] { return false; },
+                   [&](auto i, auto) { progress.push_back(i); },
+                   0,
+                   &results);
+
+    REQUIRE( progress == std::vector<uint64_t>{1, 3, 5} );
+    REQUIRE( refined.getLineCount() == 2 );
+    REQUIRE( refined.mapIndex(0) == 3 );
+    REQUIRE( refined.mapIndex(1) == 5 );
+    REQUIRE( refinedHist.get(3, 5) == 1 );
+    REQUIRE( refinedHist.get(4, 5) == 1 );
+}
+
 TEST_CASE("search_regex_control_characters") {
     std::stringstream ss("10 INFO CORE messa?ge\\ 1\n");
     auto lineParser = createTestParser();
@@ -22,3 +22,19 @@ TEST_CASE("random_bit_array") {
         }
     }
 }
+
+TEST_CASE("random_bit_array_get_range") {
+    for (int bucketSize : {2, 16, 1024}) {
+        seer::RandomBitArray rba(bucketSize);
+        for (int i = 0; i < 2000; i += 3) {
+            rba.add(i);
+        }
+        for (uint64_t first : {0, 1, 15, 16, 500}) {
+            std::vector<uint64_t> values(rba.size() - first);
+            rba.getRange(first, values);
+            for (auto i = 0u; i < values.size(); ++i) {
+                REQUIRE( values[i] == (first + i) * 3 );
+            }
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#include <catch2/catch.hpp>
+
+#include "seer/RankSelect.h"
+#include <random>
+
+TEST_CASE("rank_select_empty") {
+    ewah::EWAHBoolArray<uint64_t> array;
+    seer::RankSelect rankSelect;
+    rankSelect.init(array);
+    REQUIRE( rankSelect.size() == 0 );
+    REQUIRE( rankSelect.rank(100) == 0 );
+    REQUIRE( !rankSelect.indexOf(0) );
+}
+
+TEST_CASE("select_in_word") {
+    REQUIRE( seer::selectInWord(1, 0) == 0 );
+    REQUIRE( seer::selectInWord(0b101100, 0) == 2 );
+    REQUIRE( seer::selectInWord(0b101100, 2) == 5 );
+    REQUIRE( seer::selectInWord(~uint64_t{0}, 63) == 63 );
+    REQUIRE( seer::selectInWord(uint64_t{1} << 63, 0) == 63 );
+}
+
+TEST_CASE("rank_select_simple") {
+    ewah::EWAHBoolArray<uint64_t> array;
+    std::vector<uint64_t> values {
+        0, 3, 4, 5, 7, 10, 63, 64, 65, 105, 126, 127, 128, 500, 511, 512, 5000
+    };
+    for (auto v : values) {
+        array.set(v);
+    }
+
+    seer::RankSelect rankSelect;
+    rankSelect.init(array);
+    REQUIRE( rankSelect.size() == values.size() );
+    for (size_t i = 0; i < values.size(); ++i) {
+        REQUIRE( rankSelect.get(i) == values[i] );
+        REQUIRE( rankSelect.rank(values[i]) == i );
+        REQUIRE( rankSelect.indexOf(values[i]) == i );
+    }
+    REQUIRE( rankSelect.rank(6) == 4 );
+    REQUIRE( !rankSelect.indexOf(6) );
+    REQUIRE( !rankSelect.indexOf(5001) );
+    REQUIRE( rankSelect.rank(100000) == values.size() );
+}
+
+TEST_CASE("rank_select_random") {
+    std::mt19937 g(1);
+    // dense, sparse and runs of empty blocks between the select samples
+    for (auto gap : {5u, 300u, 20000u}) {
+        ewah::EWAHBoolArray<uint64_t> array;
+        for (uint64_t i = g() % gap; i < 2000000; i += 1 + g() % gap) {
+            array.set(i);
+        }
+        auto values = array.toArray();
+
+        seer::RankSelect rankSelect;
+        rankSelect.init(array);
+        REQUIRE( rankSelect.size() == values.size() );
+        for (size_t i = 0; i < values.size(); ++i) {
+            REQUIRE( rankSelect.get(i) == values[i] );
+            REQUIRE( rankSelect.indexOf(values[i]) == i );
+            if (values[i] > 0 && (i == 0 || values[i - 1] != values[i] - 1)) {
+                REQUIRE( !rankSelect.indexOf(values[i] - 1) );
+            }
+        }
+    }
+}
+
+TEST_CASE("rank_select_get_range") {
+    ewah::EWAHBoolArray<uint64_t> array;
+    std::mt19937 g(1);
+    for (uint64_t i = 0; i < 1000000; i += 1 + g() % 3000) {
+        array.set(i);
+    }
+    auto values = array.toArray();
+
+    seer::RankSelect rankSelect;
+    rankSelect.init(array);
+    for (uint64_t first : {0, 1, 63, 64, 200}) {
+        std::vector<uint64_t> range(values.size() - first);
+        rankSelect.getRange(first, range);
+        for (size_t i = 0; i < range.size(); ++i) {
+            REQUIRE( range[i] == values[first + i] );
+        }
+    }
+}
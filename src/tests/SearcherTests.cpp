@@ -2,26 +2,21 @@
 
 #include "seer/StringLiterals.h"
 #include "seer/Searcher.h"
+#include "seer/MultiLiteralSearcher.h"
+#include "seer/CaselessFinder.h"
 
 #include "gui/grid/CachedHighlightSearcher.h"
 
 using namespace seer;
 
 TEST_CASE("searcher_regex_dont_search_past_last_char") {
-    auto searcher = createHighlightSearcher("$$$$", true, false, false);
+    auto searcher = createSearcher("$$$$", true, false, false);
     auto [first, len] = searcher->search("123", 10);
     REQUIRE( first == -1 );
     std::tie(first, len) = searcher->search("123", 0);
     REQUIRE( first == -1 );
 }
 
-TEST_CASE("highlight_searcher_unicode_16") {
-    auto searcher = createHighlightSearcher("b", true, false, true);
-    auto [first, len] = searcher->search(u8"@1ạb|b"_as_char, 0);
-    REQUIRE( first == 4 );
-    REQUIRE( u"@1ạb|b"[first] == 'b' );
-}
-
 TEST_CASE("highlight_searcher_unicode_8") {
     auto searcher = createSearcher("b", true, false, true);
     auto [first, len] = searcher->search(u8"@1ạb|b"_as_char, 0);
@@ -29,51 +24,146 @@ TEST_CASE("highlight_searcher_unicode_8") {
     REQUIRE( u8"@1ạb|b"[first] == 'b' );
 }
 
-TEST_CASE("cached_highlight_searcher") {
-    auto searcher = createHighlightSearcher("\\d\\d", true, false, false);
-    gui::grid::CachedHighlightSearcher cachedSearcher(std::move(searcher), 100);
-    QString text = "11aa22aa33bbcc44dd";
+TEST_CASE("caseless_finder") {
+    CaselessFinder finder("Hello, World!");
+    REQUIRE( finder.find("hello, world!", 0) == 0 );
+    REQUIRE( finder.find("say HELLO, WORLD! again", 0) == 4 );
+    REQUIRE( finder.find("say HELLO, WORLD! again", 5) == std::string::npos );
+    REQUIRE( finder.find("hello, world", 0) == std::string::npos );
+    REQUIRE( finder.find("hello; world!", 0) == std::string::npos );
+    REQUIRE( finder.find("", 0) == std::string::npos );
+    REQUIRE( finder.find("hello, world!", 100) == std::string::npos );
 
-    {
-        auto [first, len] = cachedSearcher.search(text, 0, 0, 0);
-        REQUIRE( first == 0 );
-        REQUIRE( len == 2 );
-    }
+    // bytes that only differ from a letter by the case bit aren't folded
+    REQUIRE( CaselessFinder("a[").find("A{", 0) == std::string::npos );
+    REQUIRE( CaselessFinder("@").find("`", 0) == std::string::npos );
+    REQUIRE( CaselessFinder(u8"ạb"_as_char).find(u8"xẠbạB"_as_char, 0) == 5 );
+}
 
-    {
-        auto [first, len] = cachedSearcher.search(text, 1, 0, 0);
-        REQUIRE( first == 1 );
-        REQUIRE( len == 1 );
-    }
+TEST_CASE("caseless_literal_searcher") {
+    auto compare = [](std::string pattern, std::string text, bool unicodeAware) {
+        auto literal = createSearcher(pattern, false, false, unicodeAware);
+        auto regex = createSearcher(pattern, true, false, unicodeAware);
+        for (size_t start = 0; start <= text.size(); ++start) {
+            // searches start on character boundaries
+            if (start < text.size() && (static_cast<unsigned char>(text[start]) & 0xc0) == 0x80)
+                continue;
+            REQUIRE( literal->search(text, start) == regex->search(text, start) );
+        }
+    };
 
-    {
-        auto [first, len] = cachedSearcher.search(text, 2, 0, 0);
-        REQUIRE( first == 4 );
-        REQUIRE( len == 2 );
+    for (auto unicodeAware : {false, true}) {
+        compare("abcdefghijklm", "xxABCDEFGHIJKLMxxabcdefghijklmxx", unicodeAware);
+        compare("error", "Error: an ERROR, not an err", unicodeAware);
+        compare("needle", std::string(100, 'n') + "NeEdLe" + std::string(37, 'e') + "needle", unicodeAware);
+        compare(u8"über"_as_char, u8"ÜBER über Über uber"_as_char, unicodeAware);
     }
+    compare(u8"grüße"_as_char, u8"GRÜSSE GRÜßE grüße"_as_char, true);
+    compare(u8"ГРУША"_as_char, u8"груша Груша"_as_char, true);
+    // Kelvin sign and long s
+    compare("kiss", u8"\u212Aiss ki\u017Fs KISS"_as_char, true);
+}
 
-    {
-        auto [first, len] = cachedSearcher.search(text, text.size(), 0, 0);
-        REQUIRE( first == -1 );
-        REQUIRE( len == -1 );
-    }
+TEST_CASE("cached_highlight_searcher") {
+    auto searcher = createSearcher("\\d\\d", true, false, false);
+    gui::grid::CachedHighlightSearcher cachedSearcher(std::move(searcher), 100);
+    std::string text = "11aa22aa33bbcc44dd";
 
-    {
-        auto [first, len] = cachedSearcher.search(text, 100, 0, 0);
-        REQUIRE( first == -1 );
-        REQUIRE( len == -1 );
-    }
+    auto ranges = cachedSearcher.search(text, 0, 0);
+    gui::grid::HighlightRanges expected{{0, 2}, {4, 6}, {8, 10}, {14, 16}};
+    REQUIRE( *ranges == expected );
+    REQUIRE( cachedSearcher.search(text, 0, 0) == ranges );
+
+    cachedSearcher.invalidateCache();
+    REQUIRE( cachedSearcher.search(text, 0, 0) != ranges );
 }
 
 TEST_CASE("cached_highlight_searcher_empty_length_regex_result") {
-    auto searcher = createHighlightSearcher("|||", true, false, false);
+    auto searcher = createSearcher("|||", true, false, false);
     gui::grid::CachedHighlightSearcher cachedSearcher(std::move(searcher), 100);
-    QString text = "11aa22aa33bbcc44dd";
+    std::string text = "11aa22aa33bbcc44dd";
+    REQUIRE( cachedSearcher.search(text, 0, 0)->empty() );
+}
 
-    {
-        auto [first, len] = cachedSearcher.search(text, 0, 0, 0);
-        REQUIRE( first == -1 );
-        REQUIRE( len == -1 );
-    }
+TEST_CASE("highlight_ranges_unicode") {
+    auto searcher = createSearcher("b", true, false, true);
+    gui::grid::HighlightRanges ranges;
+    gui::grid::findHighlightRanges(*searcher, u8"@1ạb|b"_as_char, ranges);
+    gui::grid::HighlightRanges expected{{5, 6}, {7, 8}};
+    REQUIRE( ranges == expected );
+}
+
+TEST_CASE("searcher_match_limit") {
+    std::string line(40, 'a');
+    auto searcher = createSearcher("(a+)+$", true, true, false);
+    auto [first, len] = searcher->search(line + "!", 0);
+    REQUIRE( first == -1 );
+    REQUIRE( searcher->limitHits() == 1 );
+
+    std::tie(first, len) = searcher->search(line, 0);
+    REQUIRE( first == 0 );
+    REQUIRE( searcher->limitHits() == 1 );
+}
+
+// the engine is process-wide, it is restored even when a REQUIRE fails
+struct RegexEngineScope {
+    RegexEngine previous;
+
+    explicit RegexEngineScope(RegexEngine engine) : previous(setRegexEngine(engine)) {}
+    ~RegexEngineScope() { setRegexEngine(previous); }
+};
+
+TEST_CASE("searcher_dfa") {
+    RegexEngineScope engine(RegexEngine::Dfa);
+
+    std::string line(40, 'a');
+    auto searcher = createSearcher("(a+)+$", true, true, false);
+    auto [first, len] = searcher->search(line + "!", 0);
+    REQUIRE( first == -1 );
+    REQUIRE( searcher->limitHits() == 0 );
+    std::tie(first, len) = searcher->search("xx" + line, 0);
+    REQUIRE( first == 2 );
+    REQUIRE( len == 40 );
+
+    searcher = createSearcher("B+", true, false, false);
+    std::tie(first, len) = searcher->search("abbbc", 0);
+    REQUIRE( first == 1 );
+    REQUIRE( len == 3 );
+
+    // backreferences aren't supported by the DFA algorithm
+    searcher = createSearcher("(a)\\1", true, true, false);
+    std::tie(first, len) = searcher->search("xaxaa", 0);
+    REQUIRE( first == 3 );
+    REQUIRE( len == 2 );
 }
 
+TEST_CASE("multi_literal_searcher") {
+    MultiLiteralSearcher searcher({"he", "she", "his", "hers", "he"}, true);
+    std::vector<char> found;
+
+    searcher.search("ushers", found);
+    REQUIRE( found == std::vector<char>{1, 1, 0, 1, 1} );
+
+    searcher.search("this", found);
+    REQUIRE( found == std::vector<char>{0, 0, 1, 0, 0} );
+
+    searcher.search("HERS", found);
+    REQUIRE( found == std::vector<char>{0, 0, 0, 0, 0} );
+
+    searcher.search("", found);
+    REQUIRE( found == std::vector<char>{0, 0, 0, 0, 0} );
+}
+
+TEST_CASE("multi_literal_searcher_case_insensitive") {
+    MultiLiteralSearcher searcher({"Error", "OOM", u8"ß"_as_char}, false);
+    std::vector<char> found;
+
+    searcher.search("ERROR: oom", found);
+    REQUIRE( found == std::vector<char>{1, 1, 0} );
+
+    // only ASCII letters are folded
+    searcher.search(u8"grüßen"_as_char, found);
+    REQUIRE( found == std::vector<char>{0, 0, 1} );
+    searcher.search(u8"GRÜẞEN"_as_char, found);
+    REQUIRE( found == std::vector<char>{0, 0, 0} );
+}